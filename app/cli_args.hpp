@@ -0,0 +1,19 @@
+#pragma once
+#include <charconv>
+#include <cstdlib>
+#include <string>
+#include <system_error>
+
+// Parses a whole command-line value as a T. A value that is not a number of that type, has
+// anything after the number or does not fit prints the usage and exits with status 2, as an
+// unknown flag does.
+template <typename T> T parseNumber(const std::string& text, void (*usage)()) {
+    T value{};
+    const char* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, value);
+    if (text.empty() || ec != std::errc() || ptr != end) {
+        usage();
+        std::exit(2);
+    }
+    return value;
+}
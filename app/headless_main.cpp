@@ -0,0 +1,129 @@
+#include "cli_args.hpp"
+#include "core/simulation/CommandScript.hpp"
+#include "core/simulation/LevelSetup.hpp"
+#include "core/simulation/ScriptedRun.hpp"
+#include "core/simulation/Simulation.hpp"
+#include "core/utils/LevelLoader.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+
+namespace {
+
+struct HeadlessOptions {
+    int levelId = 1;
+    std::string levelsPath = "assets/levels.json";
+    std::string scriptPath;
+    std::uint64_t ticks = 10000;
+    std::optional<std::uint64_t> seed;
+    int frameMs = 16;
+    std::size_t tickThreads = 0;
+    std::optional<std::uint32_t> checkEvery; // unset keeps the build's default
+};
+
+void printUsage() {
+    std::cerr << "Usage: metro_headless [--level ID] [--levels PATH] [--script PATH]\n"
+                 "                      [--ticks N] [--seed S] [--frame-ms MS]\n"
+                 "                      [--tick-threads N] [--check-every N]\n";
+}
+
+HeadlessOptions parseArgs(int argc, char** argv) {
+    HeadlessOptions opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                printUsage();
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (arg == "--level") {
+            opts.levelId = parseNumber<int>(value(), printUsage);
+        } else if (arg == "--levels") {
+            opts.levelsPath = value();
+        } else if (arg == "--script") {
+            opts.scriptPath = value();
+        } else if (arg == "--ticks") {
+            opts.ticks = parseNumber<std::uint64_t>(value(), printUsage);
+        } else if (arg == "--seed") {
+            opts.seed = parseNumber<std::uint64_t>(value(), printUsage);
+        } else if (arg == "--frame-ms") {
+            opts.frameMs = parseNumber<int>(value(), printUsage);
+            if (opts.frameMs <= 0) {
+                // A frame that never advances the clock would step forever.
+                printUsage();
+                std::exit(2);
+            }
+        } else if (arg == "--tick-threads") {
+            opts.tickThreads = parseNumber<std::size_t>(value(), printUsage);
+        } else if (arg == "--check-every") {
+            opts.checkEvery = parseNumber<std::uint32_t>(value(), printUsage);
+        } else {
+            printUsage();
+            std::exit(arg == "--help" ? 0 : 2);
+        }
+    }
+    return opts;
+}
+
+} // namespace
+
+// Runs a level without a window: the simulation is stepped with the same frame delta the UI
+// uses, as fast as the machine allows, until the requested number of ticks or a failure.
+int main(int argc, char** argv) {
+    HeadlessOptions opts = parseArgs(argc, argv);
+
+    LevelConfig cfg;
+    std::vector<ScheduledCommand> script;
+    try {
+        cfg = LevelLoader(opts.levelsPath).loadLevel(opts.levelId);
+        if (!opts.scriptPath.empty()) {
+            script = CommandScript::load(opts.scriptPath);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    Simulation sim(opts.seed.value_or(cfg.seed));
+    applyLevel(sim, cfg);
+    sim.setTickThreads(opts.tickThreads);
+    if (opts.checkEvery) {
+        if (*opts.checkEvery == 0) {
+            sim.setInvariantChecks(InvariantChecks::OFF);
+        } else {
+            sim.setInvariantChecks(InvariantChecks::SAMPLED, *opts.checkEvery);
+        }
+    }
+
+    RunLimits limits{.ticks = opts.ticks, .frame = std::chrono::milliseconds(opts.frameMs)};
+    RunOutcome outcome;
+
+    auto start = std::chrono::steady_clock::now();
+    try {
+        outcome = runScripted(sim, script, limits);
+    } catch (const std::exception& e) {
+        std::cerr << "Simulation error at tick " << sim.tickCount() << ": " << e.what()
+                  << std::endl;
+        return 1;
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    double seconds = elapsed.count();
+    std::cout << "level: " << opts.levelId << "\n"
+              << "seed: " << opts.seed.value_or(cfg.seed) << "\n"
+              << "ticks: " << outcome.ticks << "\n"
+              << "seconds: " << seconds << "\n"
+              << "ticks_per_sec: " << (seconds > 0.0 ? outcome.ticks / seconds : 0.0) << "\n"
+              << "completed_passengers: " << outcome.completedPassengers << "\n"
+              << "invariant_checks: " << sim.invariantChecksRun() << "\n"
+              << "failure_tick: "
+              << (outcome.failureTick ? std::to_string(*outcome.failureTick) : "none")
+              << std::endl;
+    return outcome.failureTick ? 3 : 0;
+}
@@ -0,0 +1,104 @@
+#include "cli_args.hpp"
+#include "core/simulation/NetworkGenerator.hpp"
+#include "core/utils/LevelLoader.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+struct NetgenOptions {
+    NetworkGenParams params;
+    std::string outPath; // empty writes to stdout
+};
+
+void printUsage() {
+    std::cerr << "Usage: metro_netgen [--seed S] [--id ID] [--stations N] [--spacing PX]\n"
+                 "                    [--lines N] [--min-length N] [--max-length N]\n"
+                 "                    [--overlap P] [--trains N] [--rivers N]\n"
+                 "                    [--river-width PX] [--out PATH]\n";
+}
+
+NetgenOptions parseArgs(int argc, char** argv) {
+    NetgenOptions opts;
+    auto& p = opts.params;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                printUsage();
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (arg == "--seed") {
+            p.seed = parseNumber<std::uint64_t>(value(), printUsage);
+        } else if (arg == "--id") {
+            p.levelId = parseNumber<int>(value(), printUsage);
+        } else if (arg == "--stations") {
+            p.stations = parseNumber<int>(value(), printUsage);
+        } else if (arg == "--spacing") {
+            p.spacing = parseNumber<float>(value(), printUsage);
+        } else if (arg == "--lines") {
+            p.lines = parseNumber<int>(value(), printUsage);
+        } else if (arg == "--min-length") {
+            p.minLineLength = parseNumber<int>(value(), printUsage);
+        } else if (arg == "--max-length") {
+            p.maxLineLength = parseNumber<int>(value(), printUsage);
+        } else if (arg == "--overlap") {
+            p.overlap = parseNumber<float>(value(), printUsage);
+        } else if (arg == "--trains") {
+            p.trainsPerLine = parseNumber<int>(value(), printUsage);
+        } else if (arg == "--rivers") {
+            p.rivers = parseNumber<int>(value(), printUsage);
+        } else if (arg == "--river-width") {
+            p.riverWidth = parseNumber<float>(value(), printUsage);
+        } else if (arg == "--out") {
+            opts.outPath = value();
+        } else {
+            printUsage();
+            std::exit(arg == "--help" ? 0 : 2);
+        }
+    }
+    return opts;
+}
+
+} // namespace
+
+// Writes a generated network as a one-level levels file, loadable with
+// `metro_headless --levels PATH --level ID` or `metro_sweep --levels PATH --level ID`.
+int main(int argc, char** argv) {
+    NetgenOptions opts = parseArgs(argc, argv);
+
+    LevelConfig cfg;
+    try {
+        cfg = NetworkGenerator::generate(opts.params);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+
+    nlohmann::json file;
+    file["levels"] = nlohmann::json::array({LevelLoader::toJson(cfg, "Procedurally generated")});
+    if (opts.outPath.empty()) {
+        std::cout << file.dump(2) << std::endl;
+    } else {
+        std::ofstream out(opts.outPath);
+        if (!out) {
+            std::cerr << "Could not write " << opts.outPath << std::endl;
+            return 1;
+        }
+        out << file.dump(2) << std::endl;
+    }
+
+    std::size_t lineStations = 0;
+    for (const auto& line : cfg.initialLines) {
+        lineStations += line.stations.size();
+    }
+    std::cerr << cfg.initialStations.size() << " stations, " << cfg.initialLines.size()
+              << " lines (" << lineStations << " line stops), " << cfg.geography.size()
+              << " rivers, " << cfg.bridges << " bridges" << std::endl;
+    return 0;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "core/graph/Graph.hpp"
+#include "core/graph/StationType.hpp"
+#include "core/simulation/Simulation.hpp"
+#include "core/simulation/SimulationCommand.hpp"
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Synthetic network for benchmarks: `lines` straight lines of `stationsPerLine` stations each,
+// chained so that the last station of every line is also the first of the next one.
+struct BenchNetwork {
+    std::vector<std::uint32_t> stations;
+    std::vector<std::uint32_t> lines;
+};
+
+inline BenchNetwork buildBenchNetwork(Graph& g, int lines, int stationsPerLine, int trainsPerLine) {
+    BenchNetwork net;
+    std::uint32_t previousEnd = 0;
+    for (int l = 0; l < lines; ++l) {
+        auto line = g.addLine();
+        net.lines.push_back(line);
+        if (previousEnd != 0) {
+            g.addStationToLine(line, previousEnd);
+        }
+        int first = previousEnd != 0 ? 1 : 0;
+        for (int i = first; i < stationsPerLine; ++i) {
+            auto type = static_cast<StationType>(net.stations.size() % StationType::COUNT);
+            auto id = g.addStation(type);
+            g.getMutableStation(id).maxCapacity = SIZE_MAX;
+            g.addStationToLine(line, id);
+            net.stations.push_back(id);
+            previousEnd = id;
+        }
+        for (int t = 0; t < trainsPerLine; ++t) {
+            g.addTrain(line, 6);
+        }
+    }
+    return net;
+}
+
+// Spawns `count` passengers at random stations with random reachable destination types.
+inline void spawnBenchPassengers(Graph& g, const BenchNetwork& net, int count, std::mt19937& rng) {
+    std::uniform_int_distribution<std::size_t> stationDist(0, net.stations.size() - 1);
+    std::uniform_int_distribution<int> typeDist(0, StationType::COUNT - 1);
+    for (int i = 0; i < count; ++i) {
+        auto origin = net.stations[stationDist(rng)];
+        auto type = static_cast<StationType>(typeDist(rng));
+        if (g.getStation(origin)->type == type) {
+            continue;
+        }
+        g.spawnPassengerAt(origin, type);
+    }
+}
+
+// The same layout as buildBenchNetwork, built through commands so the Simulation also lays out
+// world geometry. Stations are placed on a grid, one row per line; ids follow creation order.
+inline void buildBenchSimulation(Simulation& sim, int lines, int stationsPerLine,
+                                 int trainsPerLine) {
+    std::uint32_t nextStation = 1;
+    std::uint32_t previousEnd = 0;
+    for (int l = 0; l < lines; ++l) {
+        std::uint32_t line = l + 1;
+        sim.enqueueCommand(AddLineCmd{line});
+        std::size_t index = 0;
+        std::uint32_t last = 0;
+        if (previousEnd != 0) {
+            sim.enqueueCommand(AddStationToLineCmd{line, previousEnd, 0, index++});
+            last = previousEnd;
+        }
+        for (int i = previousEnd != 0 ? 1 : 0; i < stationsPerLine; ++i) {
+            auto type = static_cast<StationType>((nextStation - 1) % StationType::COUNT);
+            sim.enqueueCommand(AddStationCmd{i * 80.0f, l * 120.0f, type});
+            std::uint32_t id = nextStation++;
+            sim.enqueueCommand(AddStationToLineCmd{line, id, last, index++});
+            last = id;
+        }
+        previousEnd = last;
+        for (int t = 0; t < trainsPerLine; ++t) {
+            sim.enqueueCommand(AddTrainToLineCmd{line});
+        }
+    }
+    sim.step(std::chrono::milliseconds(1000));
+}
@@ -0,0 +1,447 @@
+#include "bench_network.hpp"
+#include "core/graph/Graph.hpp"
+#include "core/graph/hop_bucket.hpp"
+#include "core/graph/passenger_pool.hpp"
+#include "core/graph/routing_cache.hpp"
+#include "core/simulation/RetainedSnapshot.hpp"
+#include "core/simulation/Simulation.hpp"
+#include "core/utils/ThreadPool.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+// Heap allocations made by this process, counted by the replacement operator new below so that
+// benchmarks can report how many each iteration makes. The plain, nothrow and aligned forms are
+// all replaced; the array forms forward to them.
+static std::atomic<std::uint64_t> allocations{0};
+
+static void* countedAlloc(std::size_t size, std::size_t alignment) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    size = std::max<std::size_t>(size, 1);
+    if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        return std::malloc(size);
+    }
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+void* operator new(std::size_t size) {
+    if (void* p = countedAlloc(size, 0)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size, 0);
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* p = countedAlloc(size, static_cast<std::size_t>(alignment))) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAlloc(size, static_cast<std::size_t>(alignment));
+}
+
+// GCC inlines these into callers of the replaced operator new and then reports free() as
+// mismatched with it; both sides use malloc/free, so the warning is a false positive here.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+// Sets the "allocs" counter to the allocations per iteration since `before`.
+static void reportAllocations(benchmark::State& state, std::uint64_t before) {
+    state.counters["allocs"] =
+        static_cast<double>(allocations.load(std::memory_order_relaxed) - before) /
+        static_cast<double>(state.iterations());
+}
+
+// Synthetic network sizes shared by the benchmarks below: {lines, stations per line, trains per
+// line, waiting passengers}.
+static void networkSizes(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"lines", "stations", "trains", "passengers"});
+    b->Args({4, 8, 1, 100});
+    b->Args({8, 12, 2, 1000});
+    b->Args({16, 24, 4, 10000});
+}
+
+static void networkSizesWithPolicy(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"lines", "stations", "trains", "passengers", "policy"});
+    for (int policy : {FIFO, SHORTEST_REMAINING_HOPS, AGING_PRIORITY}) {
+        b->Args({4, 8, 1, 100, policy});
+        b->Args({8, 12, 2, 1000, policy});
+        b->Args({16, 24, 4, 10000, policy});
+    }
+}
+
+static BenchNetwork buildFromState(Graph& g, const benchmark::State& state, std::mt19937& rng) {
+    BenchNetwork net = buildBenchNetwork(g, static_cast<int>(state.range(0)),
+                                         static_cast<int>(state.range(1)),
+                                         static_cast<int>(state.range(2)));
+    spawnBenchPassengers(g, net, static_cast<int>(state.range(3)), rng);
+    return net;
+}
+
+// One Graph::tick with a trickle of new passengers so queues do not drain to nothing.
+static void BM_GraphTick(benchmark::State& state) {
+    Graph g;
+    std::mt19937 rng(42);
+    BenchNetwork net = buildFromState(g, state, rng);
+    g.setBoardingPolicy(static_cast<BoardingPolicy>(state.range(4)));
+    int trickle = std::max<int>(1, static_cast<int>(state.range(3) / 100));
+
+    for (auto _ : state) {
+        spawnBenchPassengers(g, net, trickle, rng);
+        g.tick();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["stations"] = static_cast<double>(g.stationCount());
+}
+BENCHMARK(BM_GraphTick)->Apply(networkSizesWithPolicy)->Unit(benchmark::kMicrosecond);
+
+// Many slow empty trains, as Simulation runs them (speed 0.1), so most ticks only a few trains
+// change state. Compares visiting every train with the event-driven scheduler; there are no
+// passengers, so the tick is all train bookkeeping.
+static void BM_GraphTickScheduling(benchmark::State& state) {
+    Graph g;
+    BenchNetwork net = buildBenchNetwork(g, 16, 24, 0);
+    for (auto line : net.lines) {
+        for (std::int64_t t = 0; t < state.range(0); ++t) {
+            g.addTrain(line, 6, 0.1f);
+        }
+    }
+    g.setTickScheduling(static_cast<TickScheduling>(state.range(1)));
+
+    for (auto _ : state) {
+        g.tick();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["trains"] = static_cast<double>(g.getTrains().size());
+}
+BENCHMARK(BM_GraphTickScheduling)
+    ->ArgNames({"trainsPerLine", "scheduling"})
+    ->ArgsProduct({{4, 64}, {EVERY_TRAIN, EVENT_DRIVEN}})
+    ->Unit(benchmark::kMicrosecond);
+
+// A large network (2048 trains) with passengers, stepping trains on 1 or 4 threads.
+static void BM_GraphTickThreads(benchmark::State& state) {
+    Graph g;
+    std::mt19937 rng(42);
+    BenchNetwork net = buildBenchNetwork(g, 16, 24, 0);
+    for (auto line : net.lines) {
+        for (int t = 0; t < 128; ++t) {
+            g.addTrain(line, 6, 0.1f);
+        }
+    }
+    spawnBenchPassengers(g, net, 10000, rng);
+    ThreadPool pool(static_cast<std::size_t>(state.range(0)));
+    g.setTickPool(&pool);
+
+    for (auto _ : state) {
+        spawnBenchPassengers(g, net, 100, rng);
+        g.tick();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GraphTickThreads)->ArgName("threads")->Arg(1)->Arg(4)->Unit(benchmark::kMicrosecond);
+
+// A tick plus reading the state hash, kept incrementally (full:0) or recomputed by walking every
+// station, train and passenger (full:1).
+static void BM_StateHash(benchmark::State& state) {
+    Graph g;
+    std::mt19937 rng(42);
+    BenchNetwork net = buildBenchNetwork(g, 16, 24, 4);
+    spawnBenchPassengers(g, net, 10000, rng);
+    const bool full = state.range(0) != 0;
+
+    for (auto _ : state) {
+        spawnBenchPassengers(g, net, 100, rng);
+        g.tick();
+        benchmark::DoNotOptimize(full ? g.computeStateHash() : g.stateHash());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StateHash)->ArgName("full")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// Every (station, type) lookup right after a full invalidation: one rebuild plus the reads.
+static void BM_RoutingCold(benchmark::State& state) {
+    Graph g;
+    std::mt19937 rng(42);
+    BenchNetwork net = buildFromState(g, state, rng);
+    RoutingCache cache;
+
+    for (auto _ : state) {
+        cache.invalidate();
+        for (auto station : net.stations) {
+            for (int t = 0; t < StationType::COUNT; ++t) {
+                benchmark::DoNotOptimize(cache.get(station, static_cast<StationType>(t), g));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * net.stations.size() * StationType::COUNT);
+}
+BENCHMARK(BM_RoutingCold)->Apply(networkSizes)->Unit(benchmark::kMicrosecond);
+
+// The same lookups against a table that is already built.
+static void BM_RoutingWarm(benchmark::State& state) {
+    Graph g;
+    std::mt19937 rng(42);
+    BenchNetwork net = buildFromState(g, state, rng);
+    RoutingCache cache;
+    cache.get(net.stations.front(), StationType::CIRCLE, g);
+
+    for (auto _ : state) {
+        for (auto station : net.stations) {
+            for (int t = 0; t < StationType::COUNT; ++t) {
+                benchmark::DoNotOptimize(cache.get(station, static_cast<StationType>(t), g));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * net.stations.size() * StationType::COUNT);
+}
+BENCHMARK(BM_RoutingWarm)->Apply(networkSizes)->Unit(benchmark::kMicrosecond);
+
+static void networkSizesWithReuse(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"lines", "stations", "trains", "passengers", "reused"});
+    for (int reused : {0, 1}) {
+        b->Args({4, 8, 1, 100, reused});
+        b->Args({8, 12, 2, 1000, reused});
+        b->Args({16, 24, 4, 10000, reused});
+    }
+}
+
+// A fresh snapshot per iteration, or the same one refilled with Graph::snapshot(out).
+static void BM_GraphSnapshot(benchmark::State& state) {
+    Graph g;
+    std::mt19937 rng(42);
+    buildFromState(g, state, rng);
+    for (int i = 0; i < 20; ++i) {
+        g.tick();
+    }
+    GraphSnapshot snap;
+    g.snapshot(snap);
+    const bool reused = state.range(4) != 0;
+
+    const std::uint64_t before = allocations.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        if (reused) {
+            g.snapshot(snap);
+            benchmark::DoNotOptimize(snap.passengers.data());
+        } else {
+            benchmark::DoNotOptimize(g.snapshot());
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    reportAllocations(state, before);
+}
+BENCHMARK(BM_GraphSnapshot)->Apply(networkSizesWithReuse)->Unit(benchmark::kMicrosecond);
+
+// Simulation::snapshot adds world geometry on top of the graph snapshot. Passengers come from
+// the simulation's own spawner during a short warm-up, since stations keep their default
+// capacity here; the passenger argument only scales the warm-up length.
+static void BM_SimulationSnapshot(benchmark::State& state) {
+    Simulation sim(42);
+    buildBenchSimulation(sim, static_cast<int>(state.range(0)), static_cast<int>(state.range(1)),
+                         static_cast<int>(state.range(2)));
+    std::int64_t warmup = std::min<std::int64_t>(200, state.range(3));
+    for (std::int64_t i = 0; i < warmup && !sim.isFailed(); ++i) {
+        sim.step(std::chrono::milliseconds(1000));
+    }
+    SimulationSnapshot snap;
+    sim.snapshot(snap);
+    const bool reused = state.range(4) != 0;
+
+    const std::uint64_t before = allocations.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        if (reused) {
+            sim.snapshot(snap);
+            benchmark::DoNotOptimize(snap.passengers.data());
+        } else {
+            benchmark::DoNotOptimize(sim.snapshot());
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    reportAllocations(state, before);
+}
+BENCHMARK(BM_SimulationSnapshot)->Apply(networkSizesWithReuse)->Unit(benchmark::kMicrosecond);
+
+enum FrameView { FRESH_VIEW, RETAINED_VIEW, REUSED_VIEW };
+
+static void networkSizesWithView(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"lines", "stations", "trains", "passengers", "view"});
+    for (int view : {FRESH_VIEW, RETAINED_VIEW, REUSED_VIEW}) {
+        b->Args({4, 8, 1, 100, view});
+        b->Args({8, 12, 2, 1000, view});
+        b->Args({16, 24, 4, 10000, view});
+    }
+}
+
+// One UI frame: a 16 ms step, which ticks about once a second, then the frame's copy of the
+// state: a fresh Simulation::snapshot, a RetainedSnapshot brought up to date, or one
+// SimulationSnapshot refilled in place.
+static void BM_SimulationFrame(benchmark::State& state) {
+    Simulation sim(42);
+    buildBenchSimulation(sim, static_cast<int>(state.range(0)), static_cast<int>(state.range(1)),
+                         static_cast<int>(state.range(2)));
+    std::int64_t warmup = std::min<std::int64_t>(200, state.range(3));
+    for (std::int64_t i = 0; i < warmup && !sim.isFailed(); ++i) {
+        sim.step(std::chrono::milliseconds(1000));
+    }
+    RetainedSnapshot retained;
+    retained.update(sim);
+    SimulationSnapshot snap;
+    sim.snapshot(snap);
+    const std::int64_t view = state.range(4);
+
+    const std::uint64_t before = allocations.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        sim.step(std::chrono::milliseconds(16));
+        if (view == RETAINED_VIEW) {
+            benchmark::DoNotOptimize(retained.update(sim).tick);
+        } else if (view == REUSED_VIEW) {
+            sim.snapshot(snap);
+            benchmark::DoNotOptimize(snap.tick);
+        } else {
+            benchmark::DoNotOptimize(sim.snapshot());
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    reportAllocations(state, before);
+}
+BENCHMARK(BM_SimulationFrame)->Apply(networkSizesWithView)->Unit(benchmark::kMicrosecond);
+
+static void boardingQueueSizes(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"queue", "policy"});
+    for (int policy : {FIFO, SHORTEST_REMAINING_HOPS, AGING_PRIORITY}) {
+        for (int queue : {10, 100, 1000}) {
+            b->Args({queue, policy});
+        }
+    }
+}
+
+// One station's waiting queue with random destinations and ages, for comparing ways of picking
+// a train's boarders. Boarded passengers rejoin at the back as fresh arrivals, so the queue
+// length stays fixed.
+struct BoardingQueue {
+    Graph graph;
+    StationId station = NO_STATION;
+    PassengerPool pool;
+    std::vector<PassengerHandle> handles;
+    std::vector<std::uint32_t> ages;             // by handle
+    std::uint32_t hops[StationType::COUNT] = {}; // station -> destination type
+};
+
+static void buildBoardingQueue(BoardingQueue& q, int size) {
+    BenchNetwork net = buildBenchNetwork(q.graph, 8, 12, 0);
+    q.station = net.stations[net.stations.size() / 2];
+    StationType own = q.graph.getStation(q.station)->type;
+    for (int t = 0; t < StationType::COUNT; ++t) {
+        q.hops[t] = static_cast<std::uint32_t>(
+            q.graph.estimateRemainingHops(q.station, static_cast<StationType>(t)));
+    }
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> typeDist(0, StationType::COUNT - 1);
+    std::uniform_int_distribution<std::uint32_t> ageDist(0, 500);
+    for (int i = 0; i < size; ++i) {
+        auto type = static_cast<StationType>(typeDist(rng));
+        if (type == own) {
+            type = static_cast<StationType>((type + 1) % StationType::COUNT);
+        }
+        PassengerHandle h = q.pool.create(static_cast<PassengerId>(i + 1), q.station, type);
+        q.ages.resize(q.pool.handleBound());
+        q.ages[h] = ageDist(rng);
+        q.handles.push_back(h);
+    }
+}
+
+constexpr std::size_t BOARDERS_PER_TRAIN = 6;
+
+// The pre-bucket path: stable_sort the whole queue on every train arrival, with
+// estimateRemainingHops (a BFS) inside the comparator for SHORTEST_REMAINING_HOPS.
+static void BM_BoardingSort(benchmark::State& state) {
+    BoardingQueue q;
+    buildBoardingQueue(q, static_cast<int>(state.range(0)));
+    auto policy = static_cast<BoardingPolicy>(state.range(1));
+    auto score = [&](PassengerHandle p) {
+        if (policy == SHORTEST_REMAINING_HOPS) {
+            return SIZE_MAX - q.graph.estimateRemainingHops(q.station, q.pool.destination(p));
+        }
+        return std::size_t{q.ages[p]};
+    };
+    std::vector<PassengerHandle> order;
+
+    for (auto _ : state) {
+        order = q.handles;
+        std::stable_sort(order.begin(), order.end(), [&](PassengerHandle a, PassengerHandle b) {
+            return score(a) > score(b);
+        });
+        for (std::size_t i = 0; i < BOARDERS_PER_TRAIN && i < order.size(); ++i) {
+            q.ages[order[i]] = 0;
+            benchmark::DoNotOptimize(order[i]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * BOARDERS_PER_TRAIN);
+}
+BENCHMARK(BM_BoardingSort)->Apply(boardingQueueSizes);
+
+// HopBucket levels keyed as the FifoBoarding, AgingBoarding and ShortestHopsBoarding rules in
+// boarding_policy.hpp key them, with hop counts from a precomputed table.
+static void BM_BoardingBuckets(benchmark::State& state) {
+    BoardingQueue q;
+    buildBoardingQueue(q, static_cast<int>(state.range(0)));
+    auto policy = static_cast<BoardingPolicy>(state.range(1));
+    std::uint32_t clock = 1000;
+    auto key = [&](PassengerHandle p) -> std::uint32_t {
+        switch (policy) {
+        case FIFO:
+            return 0;
+        case AGING_PRIORITY:
+            return clock - q.ages[p];
+        case SHORTEST_REMAINING_HOPS:
+            return q.hops[q.pool.destination(p)];
+        }
+        return 0;
+    };
+    HopBucket bucket(1);
+    for (PassengerHandle h : q.handles) {
+        bucket.push(q.pool, h, key(h));
+    }
+
+    PassengerHandle boarded[BOARDERS_PER_TRAIN];
+    for (auto _ : state) {
+        std::size_t n = 0;
+        for (; n < BOARDERS_PER_TRAIN && !bucket.empty(); ++n) {
+            boarded[n] = bucket.popFront(q.pool);
+            benchmark::DoNotOptimize(boarded[n]);
+        }
+        ++clock;
+        for (std::size_t i = 0; i < n; ++i) {
+            q.ages[boarded[i]] = 0;
+            bucket.push(q.pool, boarded[i], key(boarded[i]));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * BOARDERS_PER_TRAIN);
+}
+BENCHMARK(BM_BoardingBuckets)->Apply(boardingQueueSizes);
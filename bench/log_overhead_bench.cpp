@@ -0,0 +1,20 @@
+#include "bench_network.hpp"
+#include "core/utils/Logger.hpp"
+#include <benchmark/benchmark.h>
+
+// Ticks a mid-sized network with a steady trickle of passengers. Built once per logging variant
+// (see bench/CMakeLists.txt); compare the three binaries' results.
+static void BM_TickLogging(benchmark::State& state) {
+    Graph g;
+    BenchNetwork net = buildBenchNetwork(g, 8, 12, 2);
+    std::mt19937 rng(42);
+    spawnBenchPassengers(g, net, static_cast<int>(state.range(0)), rng);
+
+    for (auto _ : state) {
+        spawnBenchPassengers(g, net, 2, rng);
+        g.tick();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["log_level"] = METRO_LOG_LEVEL;
+}
+BENCHMARK(BM_TickLogging)->Arg(100)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,23 @@
+#!/bin/bash
+set -e
+
+echo "=== Building Release Benchmarks ==="
+cmake --preset release
+cmake --build --preset release
+
+mkdir -p bench_results
+
+echo "=== Core Paths ==="
+./build/release/bench/metro_bench \
+    --benchmark_out=bench_results/core.json \
+    --benchmark_out_format=json
+echo "Wrote bench_results/core.json"
+
+echo "=== Log Overhead ==="
+# Logging variants write to stdout, so results go to JSON files instead.
+for variant in off async sync; do
+    ./build/release/bench/metro_bench_log_${variant} \
+        --benchmark_out=bench_results/log_${variant}.json \
+        --benchmark_out_format=json > /dev/null
+    echo "Wrote bench_results/log_${variant}.json"
+done
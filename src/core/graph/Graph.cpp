@@ -5,53 +5,80 @@
 #include "Station.hpp"
 #include "StationType.hpp"
 #include "Train.hpp"
+#include "core/utils/Logger.hpp"
+#include "core/utils/StateHash.hpp"
+#include "core/utils/ThreadPool.hpp"
 #include "id.hpp"
 #include "passenger_state_machine.hpp"
 #include "route_info.hpp"
 #include "train_state_machine.hpp"
 #include <algorithm>
+#include <bit>
 #include <cassert>
 #include <iostream>
+#include <numeric>
 #include <optional>
 #include <queue>
 #include <stdexcept>
 #include <string>
-#include <unordered_set>
+#include <utility>
 #include <vector>
 
 std::uint32_t Graph::addStation(StationType type) {
-    Station newStation = {this->nextStationId_, type, {}};
-    this->stations_[this->nextStationId_] = newStation;
-    routingCache_.invalidate();
-    return this->nextStationId_++;
+    StationId id = this->stations_.insert({this->stations_.nextId(), type, {}});
+    this->stationIndex_.add(id, type);
+    this->stateHash_ ^= _stationHash(this->stations_.at(id));
+    this->_changed(ChangeKind::STATION, id);
+    routingCache_.stationAdded(id, type);
+    return id;
 }
 
 StationId Graph::addStationAtPosition(float x, float y, StationType type) {
-    Station newStation = {this->nextStationId_, type, {}, x, y};
-    this->stations_[this->nextStationId_] = newStation;
-    routingCache_.invalidate();
-    return this->nextStationId_++;
+    StationId id = this->stations_.insert({this->stations_.nextId(), type, {}, {}, x, y});
+    this->stationIndex_.add(id, type);
+    this->stateHash_ ^= _stationHash(this->stations_.at(id));
+    this->_changed(ChangeKind::STATION, id);
+    routingCache_.stationAdded(id, type);
+    return id;
 }
 
 void Graph::removeStation(std::uint32_t stationId) {
-    auto stationFind = this->stations_.find(stationId);
     if (!this->stationExists(stationId)) {
         throw std::logic_error("StationId doesn't exists in removeStation");
     }
+    auto neighbours = this->adjacency_.neighbours(stationId);
+    std::vector<StationId> touched(neighbours.begin(), neighbours.end());
+
+    Station& station = this->stations_.at(stationId);
+    for (PassengerHandle p = station.waitingPassengers.front(); p != NO_PASSENGER;) {
+        PassengerHandle next = this->passengers_.next(p);
+        this->stateHash_ ^= this->_passengerHash(p);
+        this->passengers_.release(p);
+        p = next;
+    }
+    this->stateHash_ ^= _stationHash(station);
+    this->stationIndex_.remove(stationId, station.type);
     this->stations_.erase(stationId);
-    for (auto& [_, line] : this->lines_) {
-        line.stationIds.erase(
-            std::remove(line.stationIds.begin(), line.stationIds.end(), stationId),
-            line.stationIds.end());
+    this->_changed(ChangeKind::STATION, stationId);
+    for (auto&& [_, line] : this->lines_) {
+        auto& ids = line.stationIds;
+        if (std::find(ids.begin(), ids.end(), stationId) == ids.end()) {
+            continue;
+        }
+        this->stateHash_ ^= _lineHash(line);
+        ids.erase(std::remove(ids.begin(), ids.end(), stationId), ids.end());
+        this->stateHash_ ^= _lineHash(line);
+        this->_changed(ChangeKind::LINE, line.id);
     }
-    routingCache_.invalidate();
+    routingCache_.stationRemoved(stationId);
+    this->_topologyChanged(touched);
 }
 
 std::uint32_t Graph::addLine() {
-    Line newLine = {this->nextLineId_, {}};
-    this->lines_[this->nextLineId_] = newLine;
-    routingCache_.invalidate();
-    return this->nextLineId_++;
+    LineId id = this->lines_.insert({this->lines_.nextId(), {}});
+    this->stateHash_ ^= _lineHash(this->lines_.at(id));
+    this->_changed(ChangeKind::LINE, id);
+    return id;
 }
 
 void Graph::addStationToLine(std::uint32_t lineId, std::uint32_t stationId) {
@@ -61,8 +88,17 @@ void Graph::addStationToLine(std::uint32_t lineId, std::uint32_t stationId) {
     if (lineContainsStation(lineId, stationId)) {
         throw std::logic_error("Station already exists on line");
     }
-    this->lines_[lineId].stationIds.push_back(stationId);
-    routingCache_.invalidate();
+    Line& line = this->lines_.at(lineId);
+    auto& stationIds = line.stationIds;
+    this->stateHash_ ^= _lineHash(line);
+    stationIds.push_back(stationId);
+    this->stateHash_ ^= _lineHash(line);
+    this->_changed(ChangeKind::LINE, lineId);
+    if (stationIds.size() == 1) {
+        return; // a lone station on a line has no edges yet
+    }
+    std::vector<StationId> touched = {stationIds[stationIds.size() - 2], stationId};
+    this->_topologyChanged(touched);
 }
 
 void Graph::addStationToLineAtIndex(std::uint32_t lineId, std::uint32_t stationId,
@@ -73,50 +109,75 @@ void Graph::addStationToLineAtIndex(std::uint32_t lineId, std::uint32_t stationI
     if (lineContainsStation(lineId, stationId)) {
         throw std::logic_error("Station already exists on line");
     }
+    Line& line = this->lines_.at(lineId);
+    auto& stationIds = line.stationIds;
     if (index == SIZE_MAX) {
-        index = this->lines_[lineId].stationIds.size();
+        index = stationIds.size();
+    }
+    std::vector<StationId> touched = {stationId};
+    if (index > 0) {
+        touched.push_back(stationIds[index - 1]);
+    }
+    if (index < stationIds.size()) {
+        touched.push_back(stationIds[index]);
+    }
+    this->stateHash_ ^= _lineHash(line);
+    stationIds.insert(stationIds.begin() + index, stationId);
+    this->stateHash_ ^= _lineHash(line);
+    this->_changed(ChangeKind::LINE, lineId);
+    if (touched.size() > 1) {
+        this->_topologyChanged(touched);
     }
-    this->lines_[lineId].stationIds.insert(this->lines_[lineId].stationIds.begin() + index,
-                                           stationId);
-    routingCache_.invalidate();
 }
 
 void Graph::removeLine(std::uint32_t lineId) {
     if (!this->lineExists(lineId)) {
         throw std::logic_error("Line doesn't exist");
     }
+    this->stateHash_ ^= _lineHash(this->lines_.at(lineId));
+    std::vector<StationId> touched = std::move(this->lines_.at(lineId).stationIds);
     this->lines_.erase(lineId);
-    routingCache_.invalidate();
+    this->_changed(ChangeKind::LINE, lineId);
+    this->_topologyChanged(touched);
 }
 
-const Station* Graph::getStation(std::uint32_t id) const {
-    auto it = this->stations_.find(id); // assuming 'lines' is your map
-    if (it != this->stations_.end()) {
-        return &(it->second);
+void Graph::_topologyChanged(std::span<const StationId> touched) {
+    this->adjacency_.rebuild(this->stations_.indexBound(), this->lines_);
+    routingCache_.invalidateAround(touched);
+    this->hopBucketsDirty_ = true;
+    if (this->routingPolicy_ == RoutingPolicy::TRANSFER_AWARE) {
+        this->_dropCommittedRoutes();
     }
-    return nullptr;
+}
+
+const Station* Graph::getStation(std::uint32_t id) const {
+    return this->stations_.find(id);
 }
 
 const Line* Graph::getLine(std::uint32_t id) const {
-    auto it = this->lines_.find(id); // assuming 'lines' is your map
-    if (it != this->lines_.end()) {
-        return &(it->second);
-    }
-    return nullptr;
+    return this->lines_.find(id);
 }
 
 Station& Graph::getMutableStation(std::uint32_t id) {
-    auto it = this->stations_.find(id); // assuming 'lines' is your map
-    if (it != this->stations_.end()) {
-        return it->second;
+    Station* station = this->stations_.find(id);
+    if (station == nullptr) {
+        throw std::logic_error("Invalid station id in getMutableStation");
     }
-    throw std::logic_error("Invalid station id in getMutableStation");
+    return *station;
 }
 
 std::size_t Graph::stationCount() const {
     return stations_.size();
 }
 
+std::span<const StationId> Graph::stationIds() const {
+    return this->stationIndex_.ids();
+}
+
+std::uint32_t Graph::stationTypeMask() const {
+    return this->stationIndex_.typeMask();
+}
+
 std::size_t Graph::lineCount() const {
     return lines_.size();
 }
@@ -125,12 +186,32 @@ std::uint32_t Graph::completedPassengers() const {
     return this->completedPassengers_;
 }
 
+// Appends the waiting-queue length of every station, in storage order.
+void Graph::collectQueueLengths(std::vector<std::uint32_t>& out) const {
+    for (auto&& [id, station] : this->stations_) {
+        out.push_back(static_cast<std::uint32_t>(station.waitingPassengers.size()));
+    }
+}
+
+// Appends the age of every waiting passenger, station by station in storage order.
+void Graph::collectWaitTimes(std::vector<std::uint32_t>& out) const {
+    for (auto&& [id, station] : this->stations_) {
+        for (PassengerHandle p : this->passengers_.members(station.waitingPassengers)) {
+            out.push_back(this->passengers_.age(p));
+        }
+    }
+}
+
+const RoutingCacheStats& Graph::routingStats() const {
+    return this->routingCache_.stats();
+}
+
 bool Graph::stationExists(std::uint32_t id) const {
-    return this->stations_.find(id) != this->stations_.end();
+    return this->stations_.contains(id);
 }
 
 bool Graph::lineExists(std::uint32_t id) const {
-    return this->lines_.find(id) != this->lines_.end();
+    return this->lines_.contains(id);
 }
 
 bool Graph::lineContainsStation(std::uint32_t lineId, std::uint32_t stationId) const {
@@ -142,153 +223,171 @@ bool Graph::lineContainsStation(std::uint32_t lineId, std::uint32_t stationId) c
            line->stationIds.end();
 }
 
+const AdjacencyIndex& Graph::adjacency() const {
+    return this->adjacency_;
+}
+
 void Graph::spawnPassengerAt(std::uint32_t stationId, StationType destination) {
-    auto it = stations_.find(stationId);
-    if (it == stations_.end()) {
+    Station* station = stations_.find(stationId);
+    if (station == nullptr) {
         throw std::logic_error("Invalid stationId in spawnPassenger");
     }
 
-    Station& s = it->second;
+    Station& s = *station;
+    if (s.type == destination) {
+        throw std::logic_error("Passenger origin == destination");
+    }
     if (s.waitingPassengers.size() >= s.maxCapacity) {
         this->stateFailed();
         return;
     }
-    s.waitingPassengers.emplace_back(this->nextPassengerId_++, s.type, destination,
-                                     PassengerState::WAITING);
+    PassengerHandle p = this->passengers_.create(this->nextPassengerId_++, stationId, destination);
+    this->stateHash_ ^= this->_passengerHash(p);
+    this->_enqueueWaiting(s, p);
+    this->_changed(ChangeKind::STATION, stationId);
 }
 
-std::vector<std::uint32_t> Graph::_adjacentStations(std::uint32_t stationId) const {
-    std::vector<std::uint32_t> result;
-
-    for (const auto& [_, line] : lines_) {
-        const auto& v = line.stationIds;
-        for (size_t i = 0; i < v.size(); ++i) {
-            if (v[i] == stationId) {
-                if (i > 0)
-                    result.push_back(v[i - 1]);
-                if (i + 1 < v.size())
-                    result.push_back(v[i + 1]);
-            }
-        }
-    }
-
-    return result;
+const PassengerPool& Graph::passengers() const {
+    return this->passengers_;
 }
 
 bool Graph::canRoute(std::uint32_t fromStationId, StationType destinationType) {
-    const RouteInfo& r = routingCache_.get(fromStationId, destinationType, *this);
-    return r.reachable;
+    return routingCache_.get(fromStationId, destinationType, *this).reachable();
 }
 
-bool Graph::canPassengerBeServed(std::uint32_t stationId, const Passenger& p) {
-    return canRoute(stationId, p.destination);
+bool Graph::canPassengerBeServed(std::uint32_t stationId, PassengerHandle p) {
+    return canRoute(stationId, this->passengers_.destination(p));
 }
 
 std::optional<std::uint32_t> Graph::nextHop(std::uint32_t fromStationId, StationType destType) {
-    const RouteInfo& r = routingCache_.get(fromStationId, destType, *this);
-    std::cout << "Source: " << fromStationId << " Dest Type: " << destType
-              << " Reachable: " << r.reachable << "\nPath: ";
-    for (auto it : r.path) {
-        std::cout << it << " ";
-    }
-    std::cout << std::endl;
-    if (!r.reachable || r.path.size() < 2) {
+    const RouteEntry& r = routingCache_.get(fromStationId, destType, *this);
+    METRO_LOG(TRACE, ROUTING, "Source: ", fromStationId, " Dest Type: ", destType,
+              " Reachable: ", r.reachable(), " Next hop: ", r.nextHop, " Distance: ", r.distance);
+    if (!r.reachable()) {
         return std::nullopt;
     }
 
-    return r.path[1]; // path[0] == from
+    return r.nextHop;
 }
 
 RouteInfo Graph::computeRoute(StationId source, StationType destinationType) const {
-    std::cout << "Started Compute Route source: " << source << " Dest type: " << destinationType
-              << std::endl;
+    METRO_LOG(TRACE, ROUTING, "Started Compute Route source: ", source,
+              " Dest type: ", destinationType);
     RouteInfo routeInfo = {false, {}};
     if (stations_.at(source).type == destinationType) {
         return routeInfo; // already there; no movement
     }
 
+    std::vector<StationId> parent(this->stations_.indexBound(), NO_STATION);
     std::queue<StationId> q;
-    std::unordered_map<StationId, StationId> parent;
-    std::unordered_set<StationId> visited;
-
-    std::vector<StationId> path;
 
     q.push(source);
-    visited.insert(source);
+    parent[slotIndex(source)] = source;
 
     while (!q.empty()) {
-        std::uint32_t cur = q.front();
+        StationId cur = q.front();
         q.pop();
 
-        // neighbors induced by lines
-        for (const auto& [_, line] : lines_) {
-            for (size_t i = 0; i < line.stationIds.size(); ++i) {
-                if (line.stationIds[i] != cur)
-                    continue;
-
-                if (i > 0) {
-                    auto n = line.stationIds[i - 1];
-                    if (!visited.count(n)) {
-                        visited.insert(n);
-                        parent[n] = cur;
-                        if (stations_.at(n).type == destinationType) {
-                            while (parent[n] != source) {
-                                routeInfo.path.push_back(n);
-                                n = parent[n];
-                            }
-                            routeInfo.path.push_back(n);
-                            routeInfo.path.push_back(source);
-                            std::reverse(routeInfo.path.begin(), routeInfo.path.end());
-                            routeInfo.reachable = true;
-                            std::cout << "Length: " << routeInfo.path.size() << std::endl;
-                            return routeInfo;
-                        }
-                        q.push(n);
-                    }
-                }
-
-                if (i + 1 < line.stationIds.size()) {
-                    auto n = line.stationIds[i + 1];
-                    if (!visited.count(n)) {
-                        visited.insert(n);
-                        parent[n] = cur;
-                        if (stations_.at(n).type == destinationType) {
-                            while (parent[n] != source) {
-                                routeInfo.path.push_back(n);
-                                n = parent[n];
-                            }
-                            routeInfo.path.push_back(n);
-                            routeInfo.path.push_back(source);
-                            std::reverse(routeInfo.path.begin(), routeInfo.path.end());
-                            routeInfo.reachable = true;
-                            std::cout << "Length: " << routeInfo.path.size() << std::endl;
-                            return routeInfo;
-                        }
-                        q.push(n);
-                    }
+        for (StationId n : this->adjacency_.neighbours(cur)) {
+            if (parent[slotIndex(n)] != NO_STATION)
+                continue;
+            parent[slotIndex(n)] = cur;
+            if (stations_.at(n).type == destinationType) {
+                for (StationId at = n; at != source; at = parent[slotIndex(at)]) {
+                    routeInfo.path.push_back(at);
                 }
+                routeInfo.path.push_back(source);
+                std::reverse(routeInfo.path.begin(), routeInfo.path.end());
+                routeInfo.reachable = true;
+                METRO_LOG(TRACE, ROUTING, "Length: ", routeInfo.path.size());
+                return routeInfo;
             }
+            q.push(n);
         }
     }
     return routeInfo;
 }
 
-bool Graph::_canPassengerBoard(const Passenger& p, std::uint32_t stationId, const Train& train) {
-    if (p.state != PassengerState::WAITING && p.state != PassengerState::TRANSFERRING)
-        return false;
-    if (train.onboard.size() >= train.capacity)
-        return false;
-    bool board = this->_canBoard(p, stationId, train.lineId);
-    return board;
+std::optional<StationId> Graph::_plannedHop(PassengerHandle p, StationId stationId) {
+    const StationType destination = this->passengers_.destination(p);
+    if (this->routingPolicy_ == RoutingPolicy::SHORTEST_HOPS) {
+        return this->nextHop(stationId, destination);
+    }
+
+    auto& route = this->passengers_.route(p);
+    auto& routeIndex = this->passengers_.routeIndex(p);
+    if (route.empty() || route[routeIndex] != stationId) {
+        if (!this->canRoute(stationId, destination)) {
+            this->passengers_.dropRoute(p);
+            return std::nullopt;
+        }
+        CommittedRoute planned = this->planRoute(stationId, destination);
+        route.assign(planned.stations.begin(), planned.stations.end());
+        this->passengers_.routeLines(p).assign(planned.lines.begin(), planned.lines.end());
+        routeIndex = 0;
+    }
+    if (routeIndex + 1 >= route.size()) {
+        return std::nullopt;
+    }
+    return route[routeIndex + 1];
+}
+
+CommittedRoute Graph::planRoute(StationId source, StationType destination) const {
+    return this->router_.route(source, destination, *this, this->routeCosts_);
+}
+
+void Graph::setEdgeLength(StationId a, StationId b, float length) {
+    const std::uint64_t key = _edgeKey(a, b);
+    auto [it, inserted] = this->edgeLengths_.try_emplace(key, length);
+    if (!inserted) {
+        this->stateHash_ ^= StateHash::fields(StateHash::EDGE, {key, StateHash::bits(it->second)});
+        it->second = length;
+    }
+    this->stateHash_ ^= StateHash::fields(StateHash::EDGE, {key, StateHash::bits(length)});
+}
+
+float Graph::edgeLength(StationId a, StationId b) const {
+    auto it = this->edgeLengths_.find(_edgeKey(a, b));
+    return it != this->edgeLengths_.end() ? it->second : 0.0f;
+}
+
+void Graph::setRoutingPolicy(RoutingPolicy p) {
+    this->routingPolicy_ = p;
+    this->_dropCommittedRoutes();
+}
+
+void Graph::setRouteCosts(const RouteCosts& costs) {
+    this->routeCosts_ = costs;
+    this->_dropCommittedRoutes();
+}
+
+std::uint64_t Graph::_edgeKey(StationId a, StationId b) {
+    return (static_cast<std::uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+}
+
+void Graph::_dropCommittedRoutes() {
+    this->passengers_.dropAllRoutes();
+    this->hopBucketsDirty_ = true;
 }
 
-bool Graph::_canBoard(const Passenger& p, std::uint32_t stationId, std::uint32_t lineId) {
-    auto hop = nextHop(stationId, p.destination);
-    if (!hop)
-        return false;
+void Graph::_enqueueWaiting(Station& station, PassengerHandle p) {
+    this->passengers_.pushBack(station.waitingPassengers, p);
+    if (!this->hopBucketsDirty_) {
+        (this->*bucketWaiting_)(station, p);
+    }
+}
+
+BoardingContext Graph::_boardingContext(StationId stationId) {
+    return {this->passengers_, stationId, this->routingCache_, *this};
+}
 
-    const Line& line = lines_.at(lineId);
-    return std::find(line.stationIds.begin(), line.stationIds.end(), *hop) != line.stationIds.end();
+HopBucket* Graph::_findHopBucket(Station& station, StationId nextHop, LineId line) {
+    for (HopBucket& bucket : station.hopBuckets) {
+        if (bucket.nextHop() == nextHop && bucket.line() == line) {
+            return &bucket;
+        }
+    }
+    return nullptr;
 }
 
 void Graph::addTrain(std::uint32_t lineId, std::uint32_t capacity, float speed) {
@@ -312,8 +411,14 @@ void Graph::addTrain(std::uint32_t lineId, std::uint32_t capacity, float speed)
                {},
                capacity,
                0.0f,
-               speed};
+               speed,
+               this->tick_};
     this->trains_.push_back(t);
+    this->stateHash_ ^= _trainHash(t);
+    this->_changed(ChangeKind::TRAIN, static_cast<std::uint32_t>(this->trains_.size() - 1));
+    if (this->tickScheduling_ == EVENT_DRIVEN) {
+        this->_scheduleTrain(static_cast<std::uint32_t>(this->trains_.size() - 1));
+    }
 }
 
 void Graph::startTrain(std::uint32_t trainId) {
@@ -323,7 +428,13 @@ void Graph::startTrain(std::uint32_t trainId) {
         throw std::logic_error("Train doesn't exist in startTrain");
     }
     Train& t = *it;
+    this->stateHash_ ^= _trainHash(t);
     TrainFSM::idleToAlighting(t);
+    this->stateHash_ ^= _trainHash(t);
+    this->_changed(ChangeKind::TRAIN, static_cast<std::uint32_t>(it - this->trains_.begin()));
+    if (this->tickScheduling_ == EVENT_DRIVEN) {
+        this->_scheduleTrain(static_cast<std::uint32_t>(it - this->trains_.begin()));
+    }
 }
 
 const std::vector<Train>& Graph::getTrains() const {
@@ -332,23 +443,26 @@ const std::vector<Train>& Graph::getTrains() const {
 
 std::size_t Graph::estimateRemainingHops(std::uint32_t fromStationId,
                                          StationType destination) const {
+    if (!this->stationExists(fromStationId)) {
+        throw std::logic_error("Invalid station id in estimateRemainingHops");
+    }
     std::queue<std::uint32_t> q;
-    std::unordered_map<std::uint32_t, std::size_t> dist;
+    std::vector<std::size_t> dist(this->stations_.indexBound(), SIZE_MAX);
 
     q.push(fromStationId);
-    dist[fromStationId] = 0;
+    dist[slotIndex(fromStationId)] = 0;
 
     while (!q.empty()) {
         auto s = q.front();
         q.pop();
 
         if (stations_.at(s).type == destination) {
-            return dist[s];
+            return dist[slotIndex(s)];
         }
 
-        for (auto n : this->_adjacentStations(s)) {
-            if (!dist.contains(n)) {
-                dist[n] = dist[s] + 1;
+        for (auto n : this->adjacency_.neighbours(s)) {
+            if (dist[slotIndex(n)] == SIZE_MAX) {
+                dist[slotIndex(n)] = dist[slotIndex(s)] + 1;
                 q.push(n);
             }
         }
@@ -356,16 +470,25 @@ std::size_t Graph::estimateRemainingHops(std::uint32_t fromStationId,
     return SIZE_MAX; // unreachable
 }
 
-void Graph::_advanceTrainPosition(Train& t, Line& line) {
-    const std::size_t last = line.stationIds.size() - 1;
-
-    if (last == 0)
+void Graph::_advanceTrainPosition(Train& t, Line& line, TickEffects& effects) {
+    if (line.stationIds.size() < 2)
         return;
 
-    t.progress += t.speed;
+    if (this->tickScheduling_ == EVENT_DRIVEN) {
+        t.progress = this->_replayProgress(t, this->tick_);
+    } else {
+        t.progress += t.speed;
+    }
+    t.progressTick = this->tick_;
     if (t.progress < 1.0f) {
         return;
     }
+    this->_arriveAtNextStation(t, line, effects);
+}
+
+void Graph::_arriveAtNextStation(Train& t, Line& line, TickEffects& effects) {
+    const std::size_t last = line.stationIds.size() - 1;
+    effects.hashDelta ^= _trainHash(t);
     t.stationIndex += t.direction;
     t.currentStationId = t.nextStationId;
 
@@ -376,182 +499,441 @@ void Graph::_advanceTrainPosition(Train& t, Line& line) {
     }
 
     t.nextStationId = line.stationIds[t.stationIndex + t.direction];
-    std::cout << "Train " << t.trainId << " arrived at station " << t.currentStationId
-              << " next station " << t.nextStationId << " progress: " << t.progress
-              << " Current state: " << (int) t.state << std::endl;
+    METRO_LOG(DEBUG, TRAIN, "Train ", t.trainId, " arrived at station ", t.currentStationId,
+              " next station ", t.nextStationId, " progress: ", t.progress,
+              " Current state: ", t.state);
     TrainFSM::movingToAlighting(t);
+    effects.hashDelta ^= _trainHash(t);
 }
 
-void Graph::_alightPassengers(Train& train, Station& station) {
-    for (auto it = train.onboard.begin(); it != train.onboard.end();) {
-        Passenger& passenger = *it;
+void Graph::_alightPassengers(std::uint32_t trainIndex, Station& station, TickEffects& effects) {
+    Train& train = this->trains_[trainIndex];
+    PassengerPool& pool = this->passengers_;
+    for (PassengerHandle passenger = train.onboard.front(); passenger != NO_PASSENGER;) {
+        const PassengerHandle next = pool.next(passenger);
 
-        if (passenger.nextHop != station.id) {
+        if (pool.nextHop(passenger) != station.id) {
             throw std::logic_error("Passenger route desync during alight");
         }
 
-        if (station.type == passenger.destination) {
-            PassengerFSM::onTrainToCompleted(passenger);
-            it = train.onboard.erase(it);
-            this->completedPassengers_++;
+        if (station.type == pool.destination(passenger)) {
+            effects.hashDelta ^= this->_passengerHash(passenger);
+            PassengerFSM::onTrainToCompleted(pool, passenger);
+            pool.unlink(train.onboard, passenger);
+            effects.completed.emplace_back(trainIndex, passenger);
+            passenger = next;
             continue;
         }
 
-        std::optional hop = this->nextHop(station.id, passenger.destination);
+        const auto& route = pool.route(passenger);
+        if (pool.routeIndex(passenger) + 1 < route.size() &&
+            route[pool.routeIndex(passenger) + 1] == station.id) {
+            ++pool.routeIndex(passenger);
+        }
+        std::optional hop = this->_plannedHop(passenger, station.id);
         if (!hop.has_value()) {
-            std::cerr << passenger << std::endl;
+            pool.print(std::cerr, passenger);
+            std::cerr << std::endl;
             std::cerr << "Station id: " << station.id << std::endl;
             throw std::logic_error("Passenger has no where to go");
         }
         StationId nextStation = *hop;
-        passenger.nextHop = nextStation;
+        pool.nextHop(passenger) = nextStation;
+        const LineId nextLine = pool.plannedLine(passenger);
 
-        // Case 2: train continues along route → STAY ON TRAIN
-        if (this->lineContainsStation(train.lineId, nextStation)) {
-            ++it;
+        // Case 2: train continues along route on the planned line → STAY ON TRAIN
+        if (train.nextStationId == nextStation &&
+            (nextLine == ANY_LINE || nextLine == train.lineId)) {
+            passenger = next;
             continue;
         }
 
         // Case 3: transfer required → ALIGHT
-        PassengerFSM::onTrainToTransferring(passenger, station.id);
-        station.waitingPassengers.push_back(passenger);
-        it = train.onboard.erase(it);
+        effects.hashDelta ^= this->_passengerHash(passenger);
+        PassengerFSM::onTrainToTransferring(pool, passenger, station.id);
+        pool.currentLine(passenger) = 0;
+        effects.hashDelta ^= this->_passengerHash(passenger);
+        pool.unlink(train.onboard, passenger);
+        this->_enqueueWaiting(station, passenger);
+        passenger = next;
     }
 
     TrainFSM::alightingToBoarding(train);
 }
 
-void Graph::_boardPassengers(Train& train, Station& station) {
-    std::vector<Passenger>& waiting = station.waitingPassengers;
-
-    auto score = [&](const Passenger& p) {
-        switch (boardingPolicy_) {
-        case BoardingPolicy::FIFO:
-            return p.age;
+void Graph::_boardPassengers(Train& train, Station& station, TickEffects& effects) {
+    PassengerPool& pool = this->passengers_;
+    // Committed routes name their line and other passengers take any line; routing policy changes
+    // rebuild every bucket, so at most one of the two is in use.
+    HopBucket* bucket = nullptr;
+    if (train.nextStationId != NO_STATION) {
+        bucket = _findHopBucket(station, train.nextStationId, train.lineId);
+        if (bucket == nullptr || bucket->empty()) {
+            bucket = _findHopBucket(station, train.nextStationId, ANY_LINE);
+        }
+    }
 
-        case BoardingPolicy::AGING_PRIORITY:
-            return p.age;
+    METRO_LOG(TRACE, BOARDING, "Train id: ", train.trainId);
+    // Everyone in the bucket plans to ride this train's line to its next station, best candidate
+    // first.
+    while (bucket != nullptr && !bucket->empty() && train.onboard.size() < train.capacity) {
+        PassengerHandle passenger = bucket->popFront(pool);
+        METRO_LOG(TRACE, BOARDING, "Passenger id: ", pool.id(passenger), " source: ", station.id,
+                  " dest type: ", pool.destination(passenger));
+        effects.hashDelta ^= this->_passengerHash(passenger);
+        pool.currentLine(passenger) = train.lineId;
+
+        if (pool.state(passenger) == PassengerState::WAITING)
+            PassengerFSM::waitingToOnTrain(pool, passenger, train.trainId);
+        else
+            PassengerFSM::transferringToOnTrain(pool, passenger, train.trainId);
+        pool.unlink(station.waitingPassengers, passenger);
+        pool.pushBack(train.onboard, passenger);
+        effects.hashDelta ^= this->_passengerHash(passenger);
+    }
 
-        case BoardingPolicy::SHORTEST_REMAINING_HOPS:
-            return SIZE_MAX - estimateRemainingHops(station.id, p.destination);
-        }
-        return std::size_t{0};
-    };
+    TrainFSM::boardingToMoving(train);
+    train.progressTick = this->tick_;
+    train.departedTick = this->tick_;
+}
 
-    std::stable_sort(waiting.begin(), waiting.end(),
-                     [&](const Passenger& a, const Passenger& b) { return score(a) > score(b); });
-    std::cout << "Train id: " << train.trainId << std::endl;
-    for (auto it = waiting.begin(); it != waiting.end() && train.onboard.size() < train.capacity;) {
-
-        Passenger& passenger = *it;
-        bool canBoard = this->_canPassengerBoard(passenger, station.id, train);
-        std::cout << "Passenger id: " << passenger.passengerId << " can board: " << canBoard
-                  << " source: " << station.id << " dest type: " << passenger.destination
-                  << std::endl;
-        if (!canBoard) {
-            ++it;
-            continue;
-        }
+void Graph::setInvariantChecks(InvariantChecks mode, std::uint32_t sampleTicks) {
+    if (mode == InvariantChecks::SAMPLED && sampleTicks == 0) {
+        throw std::logic_error("Sampled invariant checks need a period of at least one tick");
+    }
+    this->invariantChecks_ = mode;
+    this->invariantSampleTicks_ = sampleTicks;
+}
 
-        if (!passenger.nextHop.has_value()) {
-            passenger.nextHop = this->nextHop(station.id, passenger.destination);
-        }
+std::uint64_t Graph::invariantChecksRun() const {
+    return this->invariantChecksRun_;
+}
 
-        // Must have a next step
-        if (!passenger.nextHop.has_value()) {
-            ++it;
-            continue;
-        }
+namespace {
 
-        if (passenger.state == PassengerState::WAITING)
-            PassengerFSM::waitingToOnTrain(passenger, train.trainId);
-        else
-            PassengerFSM::transferringToOnTrain(passenger, train.trainId);
-        train.onboard.push_back(passenger);
-        it = waiting.erase(it);
+void requireInvariant(bool holds, const char* what) {
+    if (!holds) {
+        throw std::logic_error(std::string("Graph invariant violated: ") + what);
     }
-
-    TrainFSM::boardingToMoving(train);
 }
 
-void Graph::_assertPassengerInvariants(const Passenger& p) const {
+} // namespace
+
+void Graph::_checkPassengerInvariants(PassengerHandle p) const {
+    requireInvariant(this->passengers_.alive(p), "queued passenger is alive");
 
-    switch (p.state) {
+    switch (this->passengers_.state(p)) {
     case PassengerState::WAITING:
-        assert(p.station.has_value());
-        assert(!p.train.has_value());
+    case PassengerState::TRANSFERRING:
+        requireInvariant(this->passengers_.station(p).has_value(), "waiting at a station");
         break;
     case PassengerState::ON_TRAIN:
-        assert(p.train.has_value());
-        assert(!p.station.has_value());
-        break;
-    case PassengerState::TRANSFERRING:
-        assert(p.station.has_value());
+        requireInvariant(this->passengers_.train(p).has_value(), "riding passenger on a train");
         break;
     case PassengerState::COMPLETED:
-        assert(!p.train.has_value());
-        assert(!p.station.has_value());
+        requireInvariant(false, "completed passenger left in a queue");
         break;
     }
 }
 
-void Graph::_assertInvariants() const {
-    std::unordered_set<const Passenger*> seen;
+void Graph::_checkInvariants() {
+    ++this->invariantChecksRun_;
+    std::vector<std::uint8_t>& seen = this->invariantSeen_;
+    seen.assign(this->passengers_.handleBound(), 0);
+    auto firstSighting = [&](PassengerHandle p) { return std::exchange(seen[p], 1) == 0; };
+
+    std::uint32_t ofType[StationType::COUNT] = {};
+    for (auto&& [id, st] : this->stations_) {
+        requireInvariant(this->stationIndex_.contains(id), "station indexed");
+        ++ofType[st.type];
+        std::size_t queued = 0;
+        for (PassengerHandle p : this->passengers_.members(st.waitingPassengers)) {
+            this->_checkPassengerInvariants(p);
+            requireInvariant(this->passengers_.station(p) == id, "waiting at its own station");
+            requireInvariant(firstSighting(p), "passenger in one queue only");
+            ++queued;
+        }
+        requireInvariant(queued == st.waitingPassengers.size(), "station queue count");
+        if (this->hopBucketsDirty_) {
+            continue;
+        }
+        std::size_t bucketed = 0;
+        for (const HopBucket& bucket : st.hopBuckets) {
+            bucket.forEach(this->passengers_, [&](PassengerHandle p) {
+                requireInvariant(this->passengers_.nextHop(p) == bucket.nextHop(),
+                                 "bucketed under its next hop");
+                requireInvariant(this->passengers_.plannedLine(p) == bucket.line(),
+                                 "bucketed under its planned line");
+                requireInvariant(this->passengers_.station(p) == id, "bucketed at its station");
+                ++bucketed;
+            });
+        }
+        requireInvariant(bucketed == st.waitingPassengers.size(), "every waiting one bucketed");
+    }
+    requireInvariant(this->stationIndex_.size() == this->stations_.size(), "no stale station ids");
+    for (int type = 0; type < StationType::COUNT; ++type) {
+        requireInvariant(ofType[type] == this->stationIndex_.count(static_cast<StationType>(type)),
+                         "station type counts");
+    }
 
-    for (const auto& [_, st] : stations_) {
-        for (const auto& p : st.waitingPassengers) {
-            this->_assertPassengerInvariants(p);
+    for (const Train& t : this->trains_) {
+        std::size_t onboard = 0;
+        for (PassengerHandle p : this->passengers_.members(t.onboard)) {
+            this->_checkPassengerInvariants(p);
+            requireInvariant(this->passengers_.train(p) == t.trainId, "riding its own train");
+            requireInvariant(firstSighting(p), "passenger in one queue only");
+            ++onboard;
         }
+        requireInvariant(onboard == t.onboard.size(), "train onboard count");
+        requireInvariant(onboard <= t.capacity, "train within capacity");
     }
+}
 
-    for (const auto& t : trains_) {
-        for (const auto& p : t.onboard) {
-            this->_assertPassengerInvariants(p);
-            assert(seen.insert(&p).second);
+void Graph::setBoardingPolicy(BoardingPolicy p) {
+    switch (p) {
+    case BoardingPolicy::FIFO:
+        this->setBoardingRule<FifoBoarding>();
+        return;
+    case BoardingPolicy::AGING_PRIORITY:
+        this->setBoardingRule<AgingBoarding>();
+        return;
+    case BoardingPolicy::SHORTEST_REMAINING_HOPS:
+        this->setBoardingRule<ShortestHopsBoarding>();
+        return;
+    }
+    throw std::logic_error("Invalid boarding policy");
+}
+
+void Graph::setTickScheduling(TickScheduling mode) {
+    if (mode == this->tickScheduling_) {
+        return;
+    }
+    this->trainWheel_.assign(TRAIN_WHEEL_SLOTS, {});
+    if (mode == EVERY_TRAIN) {
+        for (Train& t : this->trains_) {
+            if (t.state == TrainState::MOVING) {
+                t.progress = this->_replayProgress(t, this->tick_);
+                t.progressTick = this->tick_;
+            }
         }
+        this->tickScheduling_ = mode;
+        return;
+    }
+    this->tickScheduling_ = mode;
+    for (std::uint32_t i = 0; i < this->trains_.size(); ++i) {
+        this->_scheduleTrain(i);
     }
 }
 
-void Graph::_ageWaitingPassengers() {
-    for (auto& [_, station] : stations_) {
-        for (auto& p : station.waitingPassengers) {
-            ++p.age;
+// Queues the train's next state change. Alighting and boarding take one tick each; a moving
+// train arrives on the first tick its accumulated progress reaches 1.
+void Graph::_scheduleTrain(std::uint32_t trainIndex) {
+    const Train& t = this->trains_[trainIndex];
+    std::uint32_t due = this->tick_ + 1;
+    if (t.state == TrainState::IDLE) {
+        return;
+    }
+    if (t.state == TrainState::MOVING) {
+        // Count the same float additions EVERY_TRAIN would make, so both modes arrive together.
+        float progress = t.progress;
+        std::uint32_t steps = 0;
+        while (progress < 1.0f) {
+            float next = progress + t.speed;
+            if (next <= progress) {
+                return; // never arrives
+            }
+            progress = next;
+            ++steps;
         }
+        due = std::max(due, t.progressTick + steps);
     }
+    this->trainWheel_[due % TRAIN_WHEEL_SLOTS].emplace_back(due, trainIndex);
 }
 
-void Graph::setBoardingPolicy(BoardingPolicy p) {
-    this->boardingPolicy_ = p;
+// Progress of a moving train at `tick`, repeating the per-tick additions since progressTick.
+float Graph::_replayProgress(const Train& t, std::uint32_t tick) const {
+    float progress = t.progress;
+    for (std::uint32_t i = t.progressTick; i < tick; ++i) {
+        progress += t.speed;
+    }
+    return progress;
 }
 
 void Graph::tick() {
     if (this->failed_)
         return;
     this->tick_++;
-    for (Train& t : this->trains_) {
-        Line& line = this->lines_.at(t.lineId);
-        std::uint32_t stationId = line.stationIds[t.stationIndex];
-        Station& station = this->stations_.at(stationId);
-
-        switch (t.state) {
-        case TrainState::ALIGHTING:
-            this->_alightPassengers(t, station);
-            break;
-        case TrainState::BOARDING:
-            this->_boardPassengers(t, station);
-            break;
-        case TrainState::MOVING:
-            this->_advanceTrainPosition(t, line);
-            break;
-        case TrainState::IDLE:
-            break;
-        default:
-            throw std::logic_error("Invalid Train State " + std::to_string(t.trainId));
+    if (this->hopBucketsDirty_) {
+        (this->*rebuildHopBuckets_)();
+    }
+    if (this->tickScheduling_ == EVENT_DRIVEN) {
+        std::vector<TrainEvent>& slot = this->trainWheel_[this->tick_ % TRAIN_WHEEL_SLOTS];
+        this->dueTrains_.assign((this->trains_.size() + 63) / 64, 0);
+        std::erase_if(slot, [&](const TrainEvent& e) {
+            if (e.first != this->tick_) {
+                return false;
+            }
+            this->dueTrains_[e.second / 64] |= std::uint64_t{1} << (e.second % 64);
+            return true;
+        });
+        this->dueIndices_.clear();
+        for (std::size_t word = 0; word < this->dueTrains_.size(); ++word) {
+            for (std::uint64_t bits = this->dueTrains_[word]; bits != 0; bits &= bits - 1) {
+                this->dueIndices_.push_back(
+                    static_cast<std::uint32_t>(word * 64 + std::countr_zero(bits)));
+            }
+        }
+    } else {
+        this->dueIndices_.resize(this->trains_.size());
+        std::iota(this->dueIndices_.begin(), this->dueIndices_.end(), 0u);
+    }
+    this->_stepDueTrains();
+    this->_commitTickEffects();
+    this->passengers_.advanceAgingClock();
+    if (this->invariantChecks_ == InvariantChecks::SAMPLED &&
+        this->tick_ % this->invariantSampleTicks_ == 0) {
+        this->_checkInvariants();
+    }
+}
+
+void Graph::setTickPool(ThreadPool* pool) {
+    this->tickPool_ = pool;
+}
+
+void Graph::_stepDueTrains() {
+    if (this->tickPool_ != nullptr && this->tickPool_->threadCount() > 1 &&
+        this->dueIndices_.size() > TRAINS_PER_TASK) {
+        this->_stepDueTrainsParallel();
+        return;
+    }
+    for (std::uint32_t index : this->dueIndices_) {
+        this->_stepTrain(index, this->tickEffects_);
+        if (this->tickScheduling_ == EVENT_DRIVEN) {
+            this->_scheduleTrain(index);
+        }
+        if (this->invariantChecks_ == InvariantChecks::FULL) {
+            this->_checkInvariants();
+        }
+    }
+}
+
+// Splits the due trains into tasks of about TRAINS_PER_TASK. A train stopped at a station goes
+// to the task already holding that station, so every waiting queue, and the passengers in it,
+// is touched by one task only; moving trains only touch themselves. Each task keeps train order.
+void Graph::_stepDueTrainsParallel() {
+    this->taskOfSlot_.assign(this->stations_.indexBound(), NO_TASK);
+    std::size_t taskCount = 0;
+    auto openTask = [&]() -> std::uint32_t {
+        if (taskCount == 0 || this->tickTasks_[taskCount - 1].trains.size() >= TRAINS_PER_TASK) {
+            if (taskCount == this->tickTasks_.size()) {
+                this->tickTasks_.emplace_back();
+            }
+            this->tickTasks_[taskCount].trains.clear();
+            this->tickTasks_[taskCount].effects.clear();
+            ++taskCount;
+        }
+        return static_cast<std::uint32_t>(taskCount - 1);
+    };
+    for (std::uint32_t index : this->dueIndices_) {
+        const Train& t = this->trains_[index];
+        std::uint32_t task;
+        if (t.state == TrainState::ALIGHTING || t.state == TrainState::BOARDING) {
+            StationId stationId = this->lines_.at(t.lineId).stationIds[t.stationIndex];
+            std::uint32_t& stationTask = this->taskOfSlot_[slotIndex(stationId)];
+            if (stationTask == NO_TASK) {
+                stationTask = openTask();
+            }
+            task = stationTask;
+        } else {
+            task = openTask();
+        }
+        this->tickTasks_[task].trains.push_back(index);
+    }
+
+    // Routing lookups are the only shared state the tasks write to.
+    this->routingCache_.beginConcurrentReads(*this);
+    try {
+        this->tickPool_->parallelFor(taskCount, [this](std::size_t i) {
+            TickTask& task = this->tickTasks_[i];
+            for (std::uint32_t index : task.trains) {
+                this->_stepTrain(index, task.effects);
+            }
+            this->routingCache_.flushConcurrentHits();
+        });
+    } catch (...) {
+        this->routingCache_.endConcurrentReads();
+        throw;
+    }
+    this->routingCache_.endConcurrentReads();
+
+    for (std::size_t i = 0; i < taskCount; ++i) {
+        auto& completed = this->tickTasks_[i].effects.completed;
+        this->tickEffects_.completed.insert(this->tickEffects_.completed.end(), completed.begin(),
+                                            completed.end());
+        this->tickEffects_.hashDelta ^= this->tickTasks_[i].effects.hashDelta;
+        auto& changed = this->tickTasks_[i].effects.changed;
+        this->tickEffects_.changed.insert(this->tickEffects_.changed.end(), changed.begin(),
+                                          changed.end());
+    }
+    std::stable_sort(this->tickEffects_.completed.begin(), this->tickEffects_.completed.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    std::stable_sort(this->tickEffects_.changed.begin(), this->tickEffects_.changed.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    if (this->tickScheduling_ == EVENT_DRIVEN) {
+        for (std::uint32_t index : this->dueIndices_) {
+            this->_scheduleTrain(index);
+        }
+    }
+    if (this->invariantChecks_ == InvariantChecks::FULL) {
+        this->_checkInvariants();
+    }
+}
+
+void Graph::_commitTickEffects() {
+    for (auto [_, passenger] : this->tickEffects_.completed) {
+        this->passengers_.release(passenger);
+        this->completedPassengers_++;
+    }
+    this->stateHash_ ^= this->tickEffects_.hashDelta;
+    for (auto [trainIndex, stationId] : this->tickEffects_.changed) {
+        this->_changed(ChangeKind::TRAIN, trainIndex);
+        if (stationId != NO_STATION) {
+            this->_changed(ChangeKind::STATION, stationId);
         }
+    }
+    this->tickEffects_.clear();
+}
 
-        this->_assertInvariants();
+void Graph::_stepTrain(std::uint32_t trainIndex, TickEffects& effects) {
+    Train& t = this->trains_[trainIndex];
+    Line& line = this->lines_.at(t.lineId);
+    std::uint32_t stationId = line.stationIds[t.stationIndex];
+    Station& station = this->stations_.at(stationId);
+
+    switch (t.state) {
+    case TrainState::ALIGHTING:
+        effects.hashDelta ^= _trainHash(t);
+        this->_alightPassengers(trainIndex, station, effects);
+        effects.hashDelta ^= _trainHash(t);
+        effects.changed.emplace_back(trainIndex, stationId);
+        break;
+    case TrainState::BOARDING:
+        effects.hashDelta ^= _trainHash(t);
+        this->_boardPassengers(t, station, effects);
+        effects.hashDelta ^= _trainHash(t);
+        effects.changed.emplace_back(trainIndex, stationId);
+        break;
+    case TrainState::MOVING:
+        this->_advanceTrainPosition(t, line, effects);
+        if (t.state != TrainState::MOVING) {
+            effects.changed.emplace_back(trainIndex, NO_STATION);
+        }
+        break;
+    case TrainState::IDLE:
+        break;
+    default:
+        throw std::logic_error("Invalid Train State " + std::to_string(t.trainId));
     }
-    this->_ageWaitingPassengers();
 }
 
 void Graph::stateFailed() {
@@ -564,44 +946,211 @@ bool Graph::isFailed() const {
 
 GraphSnapshot Graph::snapshot() const {
     GraphSnapshot snap;
-    snap.tick = this->tick_;
-    snap.score = this->completedPassengers_;
+    this->snapshot(snap);
+    return snap;
+}
+
+void Graph::snapshot(GraphSnapshot& out) const {
+    out.tick = this->tick_;
+    out.score = this->completedPassengers_;
+
+    out.stations.clear();
+    out.trains.clear();
+    out.passengers.clear();
+    out.stations.reserve(this->stations_.size());
+    out.trains.reserve(this->trains_.size());
+    out.passengers.reserve(this->passengers_.size());
+    for (auto&& [_, s] : stations_) {
+        out.stations.push_back(this->_stationView(s, out.passengers));
+    }
+    for (const auto& t : trains_) {
+        out.trains.push_back(this->_trainView(t, out.passengers));
+    }
 
-    for (const auto& [id, s] : stations_) {
-        StationView stationView = {id, s.type, s.waitingPassengers.size(), {}};
-        for (const auto& p : s.waitingPassengers) {
-            stationView.passengers.push_back(
-                {p.passengerId, p.source, p.destination, p.state, id, std::nullopt, p.age});
-            snap.passengers.push_back(
-                {p.passengerId, p.source, p.destination, p.state, id, std::nullopt, p.age});
+    // Assigned in place so that each line keeps its stationIds buffer.
+    out.lines.resize(this->lines_.size());
+    auto lineView = out.lines.begin();
+    for (auto&& [id, line] : lines_) {
+        lineView->id = id;
+        lineView->stationIds.assign(line.stationIds.begin(), line.stationIds.end());
+        ++lineView;
+    }
+}
+
+std::uint64_t Graph::changeVersion() const {
+    return this->journal_.version();
+}
+
+void Graph::changesSince(std::uint64_t version, GraphDelta& out) {
+    out.version = this->journal_.version();
+    out.tick = this->tick_;
+    out.score = this->completedPassengers_;
+    out.agingClock = this->passengers_.agingClock();
+    out.stations.clear();
+    out.removedStations.clear();
+    out.trains.clear();
+    out.progress.clear();
+    out.passengers.clear();
+    out.lines.clear();
+    out.removedLines.clear();
+
+    std::span<const ChangeJournal::Entry> entries;
+    out.full = !this->journal_.read(version, entries) || version == 0;
+    if (out.full) {
+        for (auto&& [_, s] : this->stations_) {
+            out.stations.push_back(this->_stationView(s, out.passengers));
+        }
+        for (std::uint32_t i = 0; i < this->trains_.size(); ++i) {
+            out.trains.emplace_back(i, this->_trainView(this->trains_[i], out.passengers));
+        }
+        for (auto&& [id, line] : this->lines_) {
+            out.lines.push_back({id, line.stationIds});
         }
-        snap.stations.push_back(stationView);
+        return;
     }
 
-    for (const auto& t : trains_) {
-        TrainView trainView = {t.trainId,
-                               t.lineId,
-                               t.currentStationId,
-                               t.nextStationId,
-                               t.direction == 1 ? true : false,
-                               t.capacity,
-                               t.onboard.size(),
-                               t.state,
-                               t.progress,
-                               {}};
-        for (const auto& p : t.onboard) {
-            trainView.passengers.push_back(
-                {p.passengerId, p.source, p.destination, p.state, std::nullopt, t.trainId, p.age});
-            snap.passengers.push_back(
-                {p.passengerId, p.source, p.destination, p.state, std::nullopt, t.trainId, p.age});
-        }
-        snap.trains.push_back(trainView);
-    }
-
-    for (const auto& [id, line] : lines_) {
-        LineView lineView = {id, line.stationIds};
-        snap.lines.push_back(lineView);
+    for (auto [kind, id] : entries) {
+        switch (kind) {
+        case ChangeKind::STATION:
+            if (const Station* s = this->stations_.find(id)) {
+                out.stations.push_back(this->_stationView(*s, out.passengers));
+            } else {
+                out.removedStations.push_back(id);
+            }
+            break;
+        case ChangeKind::LINE:
+            if (const Line* line = this->lines_.find(id)) {
+                out.lines.push_back({id, line->stationIds});
+            } else {
+                out.removedLines.push_back(id);
+            }
+            break;
+        case ChangeKind::TRAIN:
+            out.trains.emplace_back(id, this->_trainView(this->trains_[id], out.passengers));
+            break;
+        }
+    }
+    std::sort(out.trains.begin(), out.trains.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    auto listed = out.trains.begin();
+    for (std::uint32_t i = 0; i < this->trains_.size(); ++i) {
+        if (listed != out.trains.end() && listed->first == i) {
+            ++listed;
+        } else if (this->trains_[i].state == TrainState::MOVING) {
+            out.progress.emplace_back(i, this->_viewProgress(this->trains_[i]));
+        }
     }
+}
 
-    return snap;
+float Graph::_viewProgress(const Train& t) const {
+    if (t.state == TrainState::MOVING && this->tickScheduling_ == EVENT_DRIVEN) {
+        return std::min(1.0f,
+                        t.progress + t.speed * static_cast<float>(this->tick_ - t.progressTick));
+    }
+    return t.progress;
+}
+
+void Graph::_changed(ChangeKind kind, std::uint32_t id) {
+    this->journal_.record(kind, id, kind == ChangeKind::TRAIN ? id : slotIndex(id));
+}
+
+StationView Graph::_stationView(const Station& station,
+                                std::vector<PassengerView>& passengers) const {
+    const PassengerPool& pool = this->passengers_;
+    StationView view = {station.id, station.type, station.waitingPassengers.size(),
+                        {static_cast<std::uint32_t>(passengers.size()),
+                         static_cast<std::uint32_t>(station.waitingPassengers.size())}};
+    for (PassengerHandle p : pool.members(station.waitingPassengers)) {
+        passengers.push_back({pool.id(p), pool.origin(p), pool.destination(p), pool.state(p),
+                              station.id, std::nullopt, pool.age(p)});
+    }
+    return view;
+}
+
+TrainView Graph::_trainView(const Train& t, std::vector<PassengerView>& passengers) const {
+    const PassengerPool& pool = this->passengers_;
+    TrainView view = {t.trainId,
+                      t.lineId,
+                      t.currentStationId,
+                      t.nextStationId,
+                      t.direction == 1 ? true : false,
+                      t.capacity,
+                      t.onboard.size(),
+                      t.state,
+                      this->_viewProgress(t),
+                      {static_cast<std::uint32_t>(passengers.size()),
+                       static_cast<std::uint32_t>(t.onboard.size())}};
+    for (PassengerHandle p : pool.members(t.onboard)) {
+        passengers.push_back({pool.id(p), pool.origin(p), pool.destination(p), pool.state(p),
+                              std::nullopt, t.trainId, pool.age(p)});
+    }
+    return view;
+}
+
+std::uint64_t Graph::stateHash() const {
+    return this->stateHash_ ^ this->_countersHash();
+}
+
+std::uint64_t Graph::computeStateHash() const {
+    std::uint64_t hash = this->_countersHash();
+    for (auto&& [_, station] : this->stations_) {
+        hash ^= _stationHash(station);
+        for (PassengerHandle p : this->passengers_.members(station.waitingPassengers)) {
+            hash ^= this->_passengerHash(p);
+        }
+    }
+    for (auto&& [_, line] : this->lines_) {
+        hash ^= _lineHash(line);
+    }
+    for (auto [key, length] : this->edgeLengths_) {
+        hash ^= StateHash::fields(StateHash::EDGE, {key, StateHash::bits(length)});
+    }
+    for (const Train& t : this->trains_) {
+        hash ^= _trainHash(t);
+        for (PassengerHandle p : this->passengers_.members(t.onboard)) {
+            hash ^= this->_passengerHash(p);
+        }
+    }
+    return hash;
+}
+
+std::uint64_t Graph::_stationHash(const Station& station) {
+    return StateHash::fields(StateHash::STATION, {station.id, station.type});
+}
+
+std::uint64_t Graph::_lineHash(const Line& line) {
+    std::uint64_t hash = StateHash::fields(StateHash::LINE, {line.id});
+    for (StationId id : line.stationIds) {
+        hash = StateHash::fields(StateHash::LINE, {hash, id});
+    }
+    return hash;
+}
+
+std::uint64_t Graph::_trainHash(const Train& t) {
+    std::uint32_t departed = t.state == TrainState::MOVING ? t.departedTick : 0;
+    return StateHash::fields(StateHash::TRAIN,
+                             {t.trainId, t.lineId, t.currentStationId, t.nextStationId,
+                              static_cast<std::uint64_t>(t.state), t.stationIndex,
+                              static_cast<std::uint64_t>(t.direction), t.capacity,
+                              StateHash::bits(t.speed), departed});
+}
+
+std::uint64_t Graph::_passengerHash(PassengerHandle p) const {
+    const PassengerPool& pool = this->passengers_;
+    // Waiting passengers all age together, so hash when they began waiting instead of the age.
+    std::uint32_t age = pool.station(p) ? pool.waitingSince(p) : pool.age(p);
+    return StateHash::fields(StateHash::PASSENGER,
+                             {pool.id(p), pool.origin(p), pool.destination(p),
+                              static_cast<std::uint64_t>(pool.state(p)), pool.location(p),
+                              pool.currentLine(p), age});
+}
+
+std::uint64_t Graph::_countersHash() const {
+    return StateHash::fields(StateHash::GRAPH,
+                             {this->tick_, this->passengers_.agingClock(), this->nextPassengerId_,
+                              this->nextTrainId_, this->completedPassengers_, this->failed_,
+                              static_cast<std::uint64_t>(this->routingPolicy_),
+                              StateHash::bits(this->routeCosts_.hop),
+                              StateHash::bits(this->routeCosts_.transfer),
+                              StateHash::bits(this->routeCosts_.length)});
 }
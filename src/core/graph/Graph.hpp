@@ -5,13 +5,57 @@
 #include "Station.hpp"
 #include "StationType.hpp"
 #include "Train.hpp"
+#include "adjacency_index.hpp"
+#include "boarding_policy.hpp"
+#include "change_journal.hpp"
+#include "passenger_pool.hpp"
 #include "route_info.hpp"
 #include "routing_cache.hpp"
+#include "slot_map.hpp"
+#include "station_index.hpp"
+#include "transit_router.hpp"
 #include <optional>
+#include <span>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
-enum BoardingPolicy { FIFO, SHORTEST_REMAINING_HOPS, AGING_PRIORITY };
+// SHORTEST_HOPS re-queries the next-hop table at every station and rides any line going there.
+// TRANSFER_AWARE plans a whole route with TransitRouter once and stores it in the passenger pool
+// as route/routeLines/routeIndex; the passenger only boards or stays on trains of the planned line.
+enum RoutingPolicy { SHORTEST_HOPS, TRANSFER_AWARE };
+
+// EVERY_TRAIN visits every train on every tick. EVENT_DRIVEN files each train in a timing wheel
+// under the tick of its next state change and only visits the trains that are due: alighting and
+// boarding trains on the next tick, moving trains on the tick their progress reaches the next
+// station. Due trains run in train order, so both modes produce the same simulation; snapshots
+// of moving trains interpolate progress instead of reading it.
+enum TickScheduling { EVERY_TRAIN, EVENT_DRIVEN };
+
+#define METRO_INVARIANTS_OFF 0
+#define METRO_INVARIANTS_FULL 1
+#define METRO_INVARIANTS_SAMPLED 2
+
+#ifndef METRO_INVARIANTS
+#ifdef NDEBUG
+#define METRO_INVARIANTS METRO_INVARIANTS_OFF
+#else
+#define METRO_INVARIANTS METRO_INVARIANTS_FULL
+#endif
+#endif
+
+#ifndef METRO_INVARIANT_SAMPLE_TICKS
+#define METRO_INVARIANT_SAMPLE_TICKS 1000
+#endif
+
+// How often Graph::tick walks every queue to check the passenger bookkeeping, throwing
+// std::logic_error on a violation. FULL checks after every train step and costs
+// O(trains x passengers) per tick; SAMPLED checks once at the end of every Nth tick, cheap enough
+// for long soak runs. The default comes from METRO_INVARIANTS (FULL in debug builds, OFF with
+// NDEBUG) and METRO_INVARIANT_SAMPLE_TICKS.
+enum class InvariantChecks { OFF, FULL, SAMPLED };
+
+class ThreadPool;
 
 class Graph {
   public:
@@ -30,55 +74,210 @@ class Graph {
     Station& getMutableStation(std::uint32_t id);
 
     std::size_t stationCount() const;
+    // Live station ids in no particular order, for picking one at random.
+    std::span<const StationId> stationIds() const;
+    // Bit `type` set for each StationType that has at least one station.
+    std::uint32_t stationTypeMask() const;
     std::size_t lineCount() const;
 
     std::uint32_t completedPassengers() const;
+    void collectQueueLengths(std::vector<std::uint32_t>& out) const;
+    void collectWaitTimes(std::vector<std::uint32_t>& out) const;
+    const RoutingCacheStats& routingStats() const;
 
     bool stationExists(std::uint32_t id) const;
     bool lineExists(std::uint32_t id) const;
     bool lineContainsStation(std::uint32_t lineId, std::uint32_t stationId) const;
+    const AdjacencyIndex& adjacency() const;
 
     std::size_t estimateRemainingHops(std::uint32_t fromStationId, StationType destination) const;
     bool canRoute(std::uint32_t fromStationId, StationType destinationType);
-    bool canPassengerBeServed(std::uint32_t stationId, const Passenger& p);
+    bool canPassengerBeServed(std::uint32_t stationId, PassengerHandle p);
     std::optional<std::uint32_t> nextHop(std::uint32_t fromStationId, StationType destType);
     RouteInfo computeRoute(StationId source, StationType destination) const;
+    CommittedRoute planRoute(StationId source, StationType destination) const;
+
+    void setEdgeLength(StationId a, StationId b, float length);
+    float edgeLength(StationId a, StationId b) const;
+    void setRoutingPolicy(RoutingPolicy p);
+    void setRouteCosts(const RouteCosts& costs);
 
     void spawnPassengerAt(std::uint32_t stationId, StationType destination);
+    const PassengerPool& passengers() const;
 
     void addTrain(std::uint32_t line, std::uint32_t capacity, float speed = 1.0f);
     void startTrain(std::uint32_t trainId);
     const std::vector<Train>& getTrains() const;
 
     void setBoardingPolicy(BoardingPolicy p);
+    void setTickScheduling(TickScheduling mode);
+    // Steps trains on `pool`, which the caller keeps alive; nullptr steps them on this thread.
+    // Trains at the same station stay on one task in train order and everything they share is
+    // committed afterwards in train order, so the result does not depend on the pool.
+    void setTickPool(ThreadPool* pool);
+    template <BoardingRule Rule> void setBoardingRule();
+    void setInvariantChecks(InvariantChecks mode,
+                            std::uint32_t sampleTicks = METRO_INVARIANT_SAMPLE_TICKS);
+    std::uint64_t invariantChecksRun() const;
     void tick();
     void stateFailed();
     bool isFailed() const;
     GraphSnapshot snapshot() const;
+    // Overwrites `out` with the current state, reusing its buffers: once they have grown to the
+    // size of the graph, refilling the same snapshot allocates nothing.
+    void snapshot(GraphSnapshot& out) const;
+    // Version of the latest change to stations, lines or trains; snapshot() is as of this one.
+    std::uint64_t changeVersion() const;
+    // Fills `out` with what changed after `version` (0 for everything). Cost follows the number
+    // of changes rather than the size of the graph, apart from one pass over the trains for the
+    // moving ones. Only the latest version read is kept, so a reader that falls behind another
+    // gets a full delta.
+    void changesSince(std::uint64_t version, GraphDelta& out);
+
+    // XOR of per-member hashes over stations, lines, edge lengths, trains and passengers, plus
+    // the counters, kept up to date by every mutation. Covers what the simulation does next, not
+    // caches derived from it: committed routes, next hops, hop buckets and the order of a queue
+    // are left out, and so is how far a moving train has got, which follows from when it left.
+    // Equal for both tick scheduling modes and with or without a tick pool.
+    std::uint64_t stateHash() const;
+    // The same hash recomputed by walking the whole graph, to check the incremental one.
+    std::uint64_t computeStateHash() const;
 
   private:
-    bool _canPassengerBoard(const Passenger& p, std::uint32_t stationId, const Train& train);
-    bool _canBoard(const Passenger& p, std::uint32_t stationId, std::uint32_t lineId);
-    std::vector<std::uint32_t> _adjacentStations(std::uint32_t stationId) const;
-    void _ageWaitingPassengers();
-    void _advanceTrainPosition(Train& t, Line& line);
-    void _alightPassengers(Train& t, Station& station);
-    void _boardPassengers(Train& t, Station& station);
-
-    void _assertPassengerInvariants(const Passenger& p) const;
-    void _assertInvariants() const;
-
-    std::uint32_t nextStationId_{1};
-    std::uint32_t nextLineId_{1};
+    friend class RoutingCache;
+
+    // State shared between trains, collected while they step and applied in train order.
+    struct TickEffects {
+        std::vector<std::pair<std::uint32_t, PassengerHandle>> completed; // (train index, handle)
+        std::uint64_t hashDelta = 0;                                      // XORed into stateHash_
+        // (train index, station it alighted or boarded at, or NO_STATION) for the change journal
+        std::vector<std::pair<std::uint32_t, StationId>> changed;
+
+        void clear() {
+            this->completed.clear();
+            this->hashDelta = 0;
+            this->changed.clear();
+        }
+    };
+    struct TickTask {
+        std::vector<std::uint32_t> trains;
+        TickEffects effects;
+    };
+
+    std::optional<StationId> _plannedHop(PassengerHandle p, StationId stationId);
+    void _dropCommittedRoutes();
+    void _enqueueWaiting(Station& station, PassengerHandle p);
+    BoardingContext _boardingContext(StationId stationId);
+    template <BoardingRule Rule>
+    void _fileInHopBucket(Station& station, PassengerHandle p, const BoardingContext& ctx);
+    template <BoardingRule Rule> void _bucketWaitingWith(Station& station, PassengerHandle p);
+    template <BoardingRule Rule> void _rebuildHopBucketsWith();
+    static HopBucket* _findHopBucket(Station& station, StationId nextHop, LineId line);
+    static std::uint64_t _edgeKey(StationId a, StationId b);
+    void _topologyChanged(std::span<const StationId> touched);
+    void _advanceTrainPosition(Train& t, Line& line, TickEffects& effects);
+    void _arriveAtNextStation(Train& t, Line& line, TickEffects& effects);
+    void _stepDueTrains();
+    void _stepDueTrainsParallel();
+    void _commitTickEffects();
+    void _stepTrain(std::uint32_t trainIndex, TickEffects& effects);
+    void _scheduleTrain(std::uint32_t trainIndex);
+    float _replayProgress(const Train& t, std::uint32_t tick) const;
+    void _alightPassengers(std::uint32_t trainIndex, Station& station, TickEffects& effects);
+    void _boardPassengers(Train& t, Station& station, TickEffects& effects);
+
+    void _changed(ChangeKind kind, std::uint32_t id);
+    // Views that append their passengers to `passengers` and refer to them by range.
+    StationView _stationView(const Station& station, std::vector<PassengerView>& passengers) const;
+    TrainView _trainView(const Train& t, std::vector<PassengerView>& passengers) const;
+    float _viewProgress(const Train& t) const;
+
+    static std::uint64_t _stationHash(const Station& station);
+    static std::uint64_t _lineHash(const Line& line);
+    static std::uint64_t _trainHash(const Train& t);
+    std::uint64_t _passengerHash(PassengerHandle p) const;
+    std::uint64_t _countersHash() const;
+
+    void _checkPassengerInvariants(PassengerHandle p) const;
+    void _checkInvariants();
+
     std::uint32_t nextTrainId_{1};
     std::uint32_t nextPassengerId_{1};
     std::uint32_t tick_{1};
-    BoardingPolicy boardingPolicy_ = FIFO;
+    // Instantiations for the current boarding rule, picked once by setBoardingRule.
+    void (Graph::*bucketWaiting_)(Station&, PassengerHandle) =
+        &Graph::_bucketWaitingWith<FifoBoarding>;
+    void (Graph::*rebuildHopBuckets_)() = &Graph::_rebuildHopBucketsWith<FifoBoarding>;
+    RoutingPolicy routingPolicy_ = SHORTEST_HOPS;
+    RouteCosts routeCosts_;
     bool failed_ = false;
+    bool hopBucketsDirty_ = false; // routing changed since the buckets were built
+    std::uint64_t stateHash_ = 0;  // see stateHash(); counters are mixed in on read
+    TickScheduling tickScheduling_ = EVERY_TRAIN;
+    InvariantChecks invariantChecks_ = static_cast<InvariantChecks>(METRO_INVARIANTS);
+    std::uint32_t invariantSampleTicks_ = METRO_INVARIANT_SAMPLE_TICKS;
+    std::uint64_t invariantChecksRun_ = 0;
+    std::vector<std::uint8_t> invariantSeen_; // by passenger handle, scratch for _checkInvariants
+    // EVENT_DRIVEN only: (due tick, index into trains_) filed in slot due % TRAIN_WHEEL_SLOTS.
+    // Trains due more than one revolution ahead wait in their slot until their tick comes round.
+    static constexpr std::uint32_t TRAIN_WHEEL_SLOTS = 64;
+    using TrainEvent = std::pair<std::uint32_t, std::uint32_t>;
+    std::vector<std::vector<TrainEvent>> trainWheel_;
+    std::vector<std::uint64_t> dueTrains_; // bitmap over trains_, walked in index order
+    std::vector<std::uint32_t> dueIndices_; // trains stepped this tick, ascending
+
+    ThreadPool* tickPool_ = nullptr;
+    static constexpr std::size_t TRAINS_PER_TASK = 32;
+    static constexpr std::uint32_t NO_TASK = UINT32_MAX;
+    std::vector<TickTask> tickTasks_;
+    std::vector<std::uint32_t> taskOfSlot_; // by slotIndex(stationId)
+    TickEffects tickEffects_;
+    ChangeJournal journal_;
 
     std::uint32_t completedPassengers_{0};
     RoutingCache routingCache_;
-    std::unordered_map<StationId, Station> stations_;
-    std::unordered_map<LineId, Line> lines_;
+    AdjacencyIndex adjacency_;
+    TransitRouter router_;
+    std::unordered_map<std::uint64_t, float> edgeLengths_;
+    PassengerPool passengers_;
+    SlotMap<Station> stations_;
+    StationIndex stationIndex_;
+    SlotMap<Line> lines_;
     std::vector<Train> trains_;
 };
+
+template <BoardingRule Rule> void Graph::setBoardingRule() {
+    this->bucketWaiting_ = &Graph::_bucketWaitingWith<Rule>;
+    this->rebuildHopBuckets_ = &Graph::_rebuildHopBucketsWith<Rule>;
+    this->hopBucketsDirty_ = true;
+}
+
+// Plans the passenger's next hop from this station and files it in the bucket for that hop and
+// its planned line. The hop only changes when routing does, which marks every bucket dirty.
+template <BoardingRule Rule>
+void Graph::_fileInHopBucket(Station& station, PassengerHandle p, const BoardingContext& ctx) {
+    StationId hop = this->_plannedHop(p, station.id).value_or(NO_STATION);
+    this->passengers_.nextHop(p) = hop;
+    const LineId line = this->passengers_.plannedLine(p);
+    HopBucket* bucket = _findHopBucket(station, hop, line);
+    if (bucket == nullptr) {
+        bucket = &station.hopBuckets.emplace_back(hop, line);
+    }
+    bucket->push(this->passengers_, p, Rule::key(ctx, p));
+}
+
+template <BoardingRule Rule>
+void Graph::_bucketWaitingWith(Station& station, PassengerHandle p) {
+    this->_fileInHopBucket<Rule>(station, p, this->_boardingContext(station.id));
+}
+
+template <BoardingRule Rule> void Graph::_rebuildHopBucketsWith() {
+    for (auto&& [id, station] : this->stations_) {
+        station.hopBuckets.clear();
+        const BoardingContext ctx = this->_boardingContext(id);
+        for (PassengerHandle p : this->passengers_.members(station.waitingPassengers)) {
+            this->_fileInHopBucket<Rule>(station, p, ctx);
+        }
+    }
+    this->hopBucketsDirty_ = false;
+}
@@ -3,7 +3,10 @@
 #include "StationType.hpp"
 #include "Train.hpp"
 #include "id.hpp"
+#include <cstdint>
 #include <optional>
+#include <span>
+#include <utility>
 #include <vector>
 
 struct PassengerView {
@@ -16,6 +19,17 @@ struct PassengerView {
     std::size_t age;
 };
 
+// Where a station's or train's passengers sit in the snapshot's flat passengers array.
+struct PassengerRange {
+    std::uint32_t first = 0;
+    std::uint32_t count = 0;
+};
+
+inline std::span<const PassengerView> passengersIn(const std::vector<PassengerView>& passengers,
+                                                   PassengerRange range) {
+    return std::span<const PassengerView>(passengers).subspan(range.first, range.count);
+}
+
 struct TrainView {
     uint32_t id;
     uint32_t lineId;
@@ -26,14 +40,14 @@ struct TrainView {
     std::size_t onboard;
     TrainState state;
     float progress;
-    std::vector<PassengerView> passengers;
+    PassengerRange passengers;
 };
 
 struct StationView {
     uint32_t id;
     StationType type;
     std::size_t waiting;
-    std::vector<PassengerView> passengers;
+    PassengerRange passengers;
 };
 
 struct LineView {
@@ -41,6 +55,8 @@ struct LineView {
     std::vector<uint32_t> stationIds;
 };
 
+// Every passenger appears once in `passengers`: the waiting ones station by station, then the
+// onboard ones train by train. Stations and trains hold their range into it.
 struct GraphSnapshot {
     uint64_t tick;
     std::vector<StationView> stations;
@@ -48,4 +64,30 @@ struct GraphSnapshot {
     std::vector<PassengerView> passengers;
     std::vector<LineView> lines;
     std::uint32_t score;
+
+    std::span<const PassengerView> passengersOf(PassengerRange range) const {
+        return passengersIn(this->passengers, range);
+    }
+};
+
+// What changed in a graph since a version, from Graph::changesSince. Changed members come as
+// fresh views; everything not listed is as it was, except that waiting passengers have aged by
+// the ticks in between and moving trains have moved on.
+struct GraphDelta {
+    std::uint64_t version; // pass back to changesSince for the next delta
+    bool full;             // the lists hold every member; drop the old copy first
+    uint64_t tick;
+    std::uint32_t score;
+    std::uint32_t agingClock; // waiting passengers age by the difference between two deltas
+    std::vector<StationView> stations;
+    std::vector<StationId> removedStations;
+    std::vector<std::pair<std::uint32_t, TrainView>> trains; // (index in trains, view)
+    std::vector<std::pair<std::uint32_t, float>> progress;   // (index, progress), other movers
+    std::vector<PassengerView> passengers;                   // of the listed stations and trains
+    std::vector<LineView> lines;
+    std::vector<LineId> removedLines;
+
+    std::span<const PassengerView> passengersOf(PassengerRange range) const {
+        return passengersIn(this->passengers, range);
+    }
 };
@@ -1,13 +1,18 @@
 #pragma once
-#include "Passenger.hpp"
 #include "StationType.hpp"
+#include "hop_bucket.hpp"
 #include "id.hpp"
+#include "passenger_pool.hpp"
 #include <vector>
 
 struct Station {
     StationId id;
     StationType type;
-    std::vector<Passenger> waitingPassengers;
+    PassengerQueue waitingPassengers;
+    // Partition of waitingPassengers by next hop and planned line, so a boarding train only walks
+    // passengers that are going where it is going on a line they will ride. Graph rebuilds these
+    // after routing changes.
+    std::vector<HopBucket> hopBuckets{};
 
     float x = 0.0f;
     float y = 0.0f;
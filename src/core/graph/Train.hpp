@@ -1,7 +1,8 @@
 #pragma once
-#include "Passenger.hpp"
 #include "id.hpp"
+#include "passenger_pool.hpp"
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 
 enum class TrainState { IDLE, ALIGHTING, BOARDING, MOVING };
@@ -15,9 +16,13 @@ struct Train {
     std::size_t stationIndex;
     
     int direction;
-    std::vector<Passenger> onboard;
+    PassengerQueue onboard;
     std::size_t capacity;
     
     float progress = 0.0f;
     float speed = 1.0f;
+    // Under TickScheduling::EVENT_DRIVEN a MOVING train's progress is only written when its
+    // arrival event fires; it holds the value as of this tick.
+    std::uint32_t progressTick = 0;
+    std::uint32_t departedTick = 0; // tick of the last BOARDING->MOVING
 };
\ No newline at end of file
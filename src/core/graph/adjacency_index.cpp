@@ -0,0 +1,54 @@
+#include "adjacency_index.hpp"
+
+void AdjacencyIndex::rebuild(std::size_t stationSlots, const SlotMap<Line>& lines) {
+    // Lines are visited in slot order, so neighbour order is deterministic.
+    this->offsets_.assign(stationSlots + 1, 0);
+    for (auto&& [_, line] : lines) {
+        const auto& v = line.stationIds;
+        for (std::size_t i = 0; i + 1 < v.size(); ++i) {
+            ++this->offsets_[slotIndex(v[i]) + 1];
+            ++this->offsets_[slotIndex(v[i + 1]) + 1];
+        }
+    }
+    for (std::size_t i = 1; i < this->offsets_.size(); ++i) {
+        this->offsets_[i] += this->offsets_[i - 1];
+    }
+
+    this->neighbours_.assign(this->offsets_.back(), NO_STATION);
+    this->lineIds_.assign(this->offsets_.back(), 0);
+    std::vector<std::uint32_t> cursor(this->offsets_.begin(), this->offsets_.end() - 1);
+    for (auto&& [id, line] : lines) {
+        const auto& v = line.stationIds;
+        for (std::size_t i = 0; i + 1 < v.size(); ++i) {
+            std::uint32_t a = cursor[slotIndex(v[i])]++;
+            this->neighbours_[a] = v[i + 1];
+            this->lineIds_[a] = id;
+
+            std::uint32_t b = cursor[slotIndex(v[i + 1])]++;
+            this->neighbours_[b] = v[i];
+            this->lineIds_[b] = id;
+        }
+    }
+}
+
+std::span<const StationId> AdjacencyIndex::neighbours(StationId stationId) const {
+    const std::uint32_t slot = slotIndex(stationId);
+    if (slot + 1 >= this->offsets_.size()) {
+        return {}; // added after the last rebuild, so it has no edges yet
+    }
+    return {this->neighbours_.data() + this->offsets_[slot],
+            this->offsets_[slot + 1] - this->offsets_[slot]};
+}
+
+std::span<const LineId> AdjacencyIndex::edgeLines(StationId stationId) const {
+    const std::uint32_t slot = slotIndex(stationId);
+    if (slot + 1 >= this->offsets_.size()) {
+        return {};
+    }
+    return {this->lineIds_.data() + this->offsets_[slot],
+            this->offsets_[slot + 1] - this->offsets_[slot]};
+}
+
+std::size_t AdjacencyIndex::edgeCount() const {
+    return this->neighbours_.size() / 2;
+}
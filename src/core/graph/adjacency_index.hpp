@@ -0,0 +1,26 @@
+#pragma once
+#include "Line.hpp"
+#include "id.hpp"
+#include "slot_map.hpp"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Compressed-sparse-row view of the station graph induced by lines_. The neighbours of a station
+// live in one contiguous slice of neighbours_ (with the owning line of each edge at the same
+// position in lineIds_), so enumerating them no longer scans every line.
+class AdjacencyIndex {
+  public:
+    // stationSlots bounds slotIndex() of every station id.
+    void rebuild(std::size_t stationSlots, const SlotMap<Line>& lines);
+
+    std::span<const StationId> neighbours(StationId stationId) const;
+    std::span<const LineId> edgeLines(StationId stationId) const;
+
+    std::size_t edgeCount() const;
+
+  private:
+    std::vector<std::uint32_t> offsets_;
+    std::vector<StationId> neighbours_;
+    std::vector<LineId> lineIds_;
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include "StationType.hpp"
+#include "id.hpp"
+#include "passenger_pool.hpp"
+#include "routing_cache.hpp"
+#include <concepts>
+#include <cstdint>
+
+class Graph;
+
+enum BoardingPolicy { FIFO, SHORTEST_REMAINING_HOPS, AGING_PRIORITY };
+
+// What a boarding rule may look at when a passenger joins a station's queue.
+struct BoardingContext {
+    const PassengerPool& passengers;
+    StationId station;
+    RoutingCache& routes;
+    const Graph& graph;
+
+    std::uint32_t hopsTo(StationType destination) const {
+        return this->routes.get(this->station, destination, this->graph).distance;
+    }
+};
+
+// A boarding rule maps a waiting passenger to a key; lower keys board first and equal keys board
+// in arrival order. Graph computes the key once, when the passenger joins the queue, and re-keys
+// every queue after routing or policy changes, so a key may only depend on state that stays
+// fixed while the passenger waits. Rules are stateless types used as template arguments of
+// Graph::setBoardingRule, so the key inlines into the bucketing loop.
+template <typename Rule>
+concept BoardingRule = requires(const BoardingContext& ctx, PassengerHandle p) {
+    { Rule::key(ctx, p) } -> std::convertible_to<std::uint32_t>;
+};
+
+struct FifoBoarding {
+    static std::uint32_t key(const BoardingContext&, PassengerHandle) {
+        return 0;
+    }
+};
+
+// Waiting passengers all age together, so the clock they began waiting at ranks them by age.
+struct AgingBoarding {
+    static std::uint32_t key(const BoardingContext& ctx, PassengerHandle p) {
+        return ctx.passengers.waitingSince(p);
+    }
+};
+
+struct ShortestHopsBoarding {
+    static std::uint32_t key(const BoardingContext& ctx, PassengerHandle p) {
+        return ctx.hopsTo(ctx.passengers.destination(p));
+    }
+};
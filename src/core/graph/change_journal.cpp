@@ -0,0 +1,31 @@
+#include "change_journal.hpp"
+#include <algorithm>
+
+void ChangeJournal::record(ChangeKind kind, std::uint32_t id, std::size_t slot) {
+    std::vector<Stamp>& stamps = this->stamps_[static_cast<std::size_t>(kind)];
+    if (slot >= stamps.size()) {
+        stamps.resize(slot + 1);
+    }
+    Stamp& stamp = stamps[slot];
+    if (stamp.id == id && stamp.version > this->readVersion_) {
+        return; // still unread, and readers rebuild the member from its current state
+    }
+    this->entries_.push_back({kind, id});
+    stamp = {id, this->version()};
+}
+
+bool ChangeJournal::read(std::uint64_t version, std::span<const Entry>& out) {
+    this->readVersion_ = this->version();
+    if (version + 1 < this->base_) {
+        this->base_ = this->readVersion_ + 1;
+        this->entries_.clear();
+        out = {};
+        return false;
+    }
+    const std::size_t seen =
+        std::min<std::size_t>(version + 1 - this->base_, this->entries_.size());
+    this->entries_.erase(this->entries_.begin(), this->entries_.begin() + seen);
+    this->base_ += seen;
+    out = this->entries_;
+    return true;
+}
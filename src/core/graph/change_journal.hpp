@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+enum class ChangeKind : std::uint8_t { STATION, LINE, TRAIN };
+
+// Ordered record of which stations, lines and trains changed, so a reader holding a copy of the
+// state at version V only rebuilds what changed after V. Every entry is a new version. A member
+// is listed at most once among the entries no reader has seen yet, so however long nobody reads,
+// the journal stays as long as the number of members. Reading drops the entries the reader has
+// seen; a reader further behind than that has to start over from a full copy.
+class ChangeJournal {
+  public:
+    struct Entry {
+        ChangeKind kind;
+        std::uint32_t id; // station or line id, train index
+    };
+
+    // `slot` is a dense index for the member (slotIndex(id) for stations and lines) used to
+    // skip members already listed among the unread entries.
+    void record(ChangeKind kind, std::uint32_t id, std::size_t slot);
+
+    // Version of the latest entry, 0 before the first one.
+    std::uint64_t version() const {
+        return this->base_ + this->entries_.size() - 1;
+    }
+    // Sets `out` to the entries after `version` and drops the ones up to it. Returns false, and
+    // drops everything, when an earlier read already dropped some of them; the reader then needs
+    // a full copy as of version(). `out` stays valid until the next record() or read().
+    bool read(std::uint64_t version, std::span<const Entry>& out);
+
+  private:
+    struct Stamp {
+        std::uint32_t id = 0;
+        std::uint64_t version = 0;
+    };
+
+    std::uint64_t base_ = 1;        // version of entries_[0]
+    std::uint64_t readVersion_ = 0; // latest version handed to a reader
+    std::vector<Entry> entries_;
+    std::vector<Stamp> stamps_[3];
+};
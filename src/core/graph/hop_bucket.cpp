@@ -0,0 +1,51 @@
+#include "hop_bucket.hpp"
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+void HopBucket::push(PassengerPool& pool, PassengerHandle h, std::uint32_t key) {
+    auto first = this->levels_.begin() + static_cast<std::ptrdiff_t>(this->head_);
+    auto it = this->levels_.end();
+    if (it != first && std::prev(it)->key > key) {
+        it = std::upper_bound(first, it, key,
+                              [](std::uint32_t k, const Level& level) { return k < level.key; });
+    }
+    if (it != first && std::prev(it)->key == key) {
+        --it;
+    } else if (it == first && this->head_ > 0) {
+        // Below every level: reuse the slot the last emptied front level left.
+        --this->head_;
+        --it;
+        *it = Level{key, {}};
+    } else {
+        it = this->levels_.insert(it, Level{key, {}});
+    }
+    pool.pushBack(it->queue, h, QueueLane::HOP);
+    ++this->count_;
+}
+
+PassengerHandle HopBucket::front() const {
+    return this->count_ == 0 ? NO_PASSENGER : this->levels_[this->head_].queue.front();
+}
+
+PassengerHandle HopBucket::popFront(PassengerPool& pool) {
+    if (this->count_ == 0) {
+        throw std::logic_error("popFront on an empty HopBucket");
+    }
+    PassengerQueue& queue = this->levels_[this->head_].queue;
+    PassengerHandle h = queue.front();
+    pool.unlink(queue, h, QueueLane::HOP);
+    if (queue.empty()) {
+        ++this->head_;
+        if (this->head_ == this->levels_.size()) {
+            this->levels_.clear();
+            this->head_ = 0;
+        } else if (this->head_ * 2 >= this->levels_.size()) {
+            this->levels_.erase(this->levels_.begin(),
+                                this->levels_.begin() + static_cast<std::ptrdiff_t>(this->head_));
+            this->head_ = 0;
+        }
+    }
+    --this->count_;
+    return h;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "id.hpp"
+#include "passenger_pool.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Waiting passengers at one station whose planned next hop is nextHop() (NO_STATION when they
+// have no route) on line() (ANY_LINE when any line will do), linked through the pool's HOP lane.
+// Passengers are grouped into levels by boarding key: the lowest key boards first and each level
+// keeps arrival order, so the next boarder is always the front of the first level. Empty levels
+// are dropped.
+class HopBucket {
+  public:
+    explicit HopBucket(StationId nextHop, LineId line = ANY_LINE)
+        : nextHop_(nextHop), line_(line) {}
+
+    StationId nextHop() const {
+        return this->nextHop_;
+    }
+    LineId line() const {
+        return this->line_;
+    }
+    std::size_t size() const {
+        return this->count_;
+    }
+    bool empty() const {
+        return this->count_ == 0;
+    }
+
+    // Finds the key's level by binary search; a key above or below every level is O(1).
+    void push(PassengerPool& pool, PassengerHandle h, std::uint32_t key);
+    PassengerHandle front() const;
+    PassengerHandle popFront(PassengerPool& pool);
+
+    // Visits every member in boarding order.
+    template <typename Fn> void forEach(const PassengerPool& pool, Fn&& fn) const {
+        for (std::size_t i = this->head_; i < this->levels_.size(); ++i) {
+            const Level& level = this->levels_[i];
+            for (PassengerHandle h : pool.members(level.queue, QueueLane::HOP)) {
+                fn(h);
+            }
+        }
+    }
+
+  private:
+    struct Level {
+        std::uint32_t key;
+        PassengerQueue queue;
+    };
+
+    StationId nextHop_;
+    LineId line_;
+    // Ascending key from head_. Levels emptied at the front are skipped rather than erased and
+    // compacted away once they make up half the vector, so popFront is amortised O(1).
+    std::vector<Level> levels_;
+    std::size_t head_ = 0;
+    std::uint32_t count_ = 0;
+};
@@ -4,4 +4,20 @@
 using PassengerId = std::uint32_t;
 using StationId = std::uint32_t;
 using LineId = std::uint32_t;
-using TrainId = std::uint32_t;
\ No newline at end of file
+using TrainId = std::uint32_t;
+
+// Ids are handed out starting from 1, so 0 never names a real station.
+constexpr StationId NO_STATION = 0;
+// Line ids start from 1 as well; a hop planned on ANY_LINE may be ridden on any line.
+constexpr LineId ANY_LINE = 0;
+
+// Station and line ids carry their storage slot in the low ID_SLOT_BITS (as slot + 1) and the
+// slot's generation above that. A freed slot is reused with the next generation, so a stale id
+// never resolves to the new occupant. Generation-0 ids are 1, 2, 3, ... in creation order.
+constexpr std::uint32_t ID_SLOT_BITS = 20;
+constexpr std::uint32_t ID_SLOT_MASK = (1u << ID_SLOT_BITS) - 1;
+
+// Dense table index of an id: 1-based, so row 0 stays free for NO_STATION.
+constexpr std::uint32_t slotIndex(std::uint32_t id) {
+    return id & ID_SLOT_MASK;
+}
@@ -0,0 +1,140 @@
+#include "passenger_pool.hpp"
+#include <stdexcept>
+
+PassengerHandle PassengerPool::create(PassengerId id, StationId origin,
+                                      StationType destination) {
+    PassengerHandle h;
+    if (!this->free_.empty()) {
+        h = this->free_.back();
+        this->free_.pop_back();
+    } else {
+        if (this->live_.size() >= NO_PASSENGER) {
+            throw std::logic_error("PassengerPool is full");
+        }
+        h = static_cast<PassengerHandle>(this->live_.size());
+        this->ids_.emplace_back();
+        this->destinations_.emplace_back();
+        this->states_.emplace_back();
+        this->nextHops_.emplace_back();
+        this->waitClocks_.emplace_back();
+        this->locations_.emplace_back();
+        for (auto& links : this->links_) {
+            links.emplace_back();
+        }
+        this->cold_.emplace_back();
+        this->live_.emplace_back();
+    }
+
+    this->ids_[h] = id;
+    this->destinations_[h] = static_cast<std::uint8_t>(destination);
+    this->states_[h] = PassengerState::WAITING;
+    this->nextHops_[h] = NO_STATION;
+    this->waitClocks_[h] = this->agingClock_; // waiting, age 0
+    this->locations_[h] = origin;
+    for (auto& links : this->links_) {
+        links[h] = Links{};
+    }
+    Cold& cold = this->cold_[h];
+    cold.origin = origin;
+    cold.currentLine = 0;
+    cold.routeIndex = 0;
+    cold.route.clear(); // keeps its capacity for the next passenger in this slot
+    cold.routeLines.clear();
+    this->live_[h] = 1;
+    ++this->size_;
+    return h;
+}
+
+void PassengerPool::release(PassengerHandle h) {
+    if (!this->alive(h)) {
+        throw std::logic_error("Releasing a dead passenger handle");
+    }
+    this->live_[h] = 0;
+    this->free_.push_back(h);
+    --this->size_;
+}
+
+void PassengerPool::pushBack(PassengerQueue& q, PassengerHandle h, QueueLane lane) {
+    std::vector<Links>& links = this->_links(lane);
+    links[h] = {q.tail, NO_PASSENGER};
+    if (q.tail == NO_PASSENGER) {
+        q.head = h;
+    } else {
+        links[q.tail].next = h;
+    }
+    q.tail = h;
+    ++q.count;
+}
+
+void PassengerPool::unlink(PassengerQueue& q, PassengerHandle h, QueueLane lane) {
+    std::vector<Links>& links = this->_links(lane);
+    auto [prev, next] = links[h];
+    if (prev == NO_PASSENGER) {
+        q.head = next;
+    } else {
+        links[prev].next = next;
+    }
+    if (next == NO_PASSENGER) {
+        q.tail = prev;
+    } else {
+        links[next].prev = prev;
+    }
+    links[h] = Links{};
+    --q.count;
+}
+
+std::optional<StationId> PassengerPool::station(PassengerHandle h) const {
+    PassengerState s = this->states_[h];
+    if (s == PassengerState::WAITING || s == PassengerState::TRANSFERRING) {
+        return this->locations_[h];
+    }
+    return std::nullopt;
+}
+
+std::optional<TrainId> PassengerPool::train(PassengerHandle h) const {
+    if (this->states_[h] == PassengerState::ON_TRAIN) {
+        return this->locations_[h];
+    }
+    return std::nullopt;
+}
+
+void PassengerPool::dropRoute(PassengerHandle h) {
+    this->cold_[h].route.clear();
+    this->cold_[h].routeLines.clear();
+    this->cold_[h].routeIndex = 0;
+}
+
+void PassengerPool::dropAllRoutes() {
+    for (PassengerHandle h = 0; h < this->live_.size(); ++h) {
+        if (this->live_[h]) {
+            this->dropRoute(h);
+        }
+    }
+}
+
+void PassengerPool::print(std::ostream& os, PassengerHandle h) const {
+    os << "[Passenger " << this->ids_[h] << "]\n"
+       << "  Source Station ID: " << this->origin(h) << "\n"
+       << "  Target Type:       " << static_cast<int>(this->destination(h)) << "\n"
+       << "  State:             " << to_string(this->state(h)) << "\n";
+
+    if (auto s = this->station(h))
+        os << "  At Station:        " << *s << "\n";
+    if (auto t = this->train(h))
+        os << "  On Train:          " << *t << "\n";
+    if (this->nextHop(h) != NO_STATION)
+        os << "  Next Hop:          " << this->nextHop(h) << "\n";
+
+    const auto& route = this->route(h);
+    if (!route.empty()) {
+        os << "  Route:             ";
+        for (std::size_t i = 0; i < route.size(); ++i) {
+            os << route[i] << (i == this->routeIndex(h) ? "*" : "")
+               << (i < route.size() - 1 ? " -> " : "");
+        }
+        os << "\n";
+    }
+
+    os << "  Age:               " << this->age(h) << " ticks\n"
+       << "---------------------------";
+}
@@ -0,0 +1,251 @@
+#pragma once
+#include "Passenger.hpp"
+#include "StationType.hpp"
+#include "id.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+using PassengerHandle = std::uint32_t;
+constexpr PassengerHandle NO_PASSENGER = UINT32_MAX;
+
+// FIFO of passenger handles threaded through the pool's link arrays, so push and unlink are O(1)
+// and walking the queue yields arrival order without sorting. Each lane has its own links: a
+// passenger sits in at most one MAIN queue (a station's waiting line or a train's onboard list)
+// and, while waiting, in one HOP queue (its station's bucket for its next hop).
+enum class QueueLane : std::uint8_t { MAIN, HOP };
+
+struct PassengerQueue {
+    PassengerHandle head = NO_PASSENGER;
+    PassengerHandle tail = NO_PASSENGER;
+    std::uint32_t count = 0;
+
+    std::size_t size() const {
+        return this->count;
+    }
+    bool empty() const {
+        return this->count == 0;
+    }
+    PassengerHandle front() const {
+        return this->head;
+    }
+};
+
+// Structure-of-arrays store for every live passenger. Stations and trains only hold 32-bit
+// handles, so boarding and alighting move a handle instead of copying a record. The fields read
+// for every waiting passenger each tick (id, destination, state, next hop, wait clock, location)
+// sit in their own arrays; committed routes and other routing bookkeeping live in a separate cold
+// array. Released handles are reused.
+//
+// Ages are lazy: the pool keeps an aging clock that Graph advances once per tick, and a waiting
+// passenger's age is the clock minus the clock value it started waiting at, so aging everyone
+// costs one increment.
+class PassengerPool {
+  public:
+    class QueueIterator {
+      public:
+        using value_type = PassengerHandle;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = PassengerHandle;
+        using iterator_category = std::forward_iterator_tag;
+
+        QueueIterator() = default;
+        QueueIterator(const PassengerPool* pool, PassengerHandle h, QueueLane lane)
+            : pool_(pool), h_(h), lane_(lane) {}
+        PassengerHandle operator*() const {
+            return this->h_;
+        }
+        QueueIterator& operator++() {
+            this->h_ = this->pool_->next(this->h_, this->lane_);
+            return *this;
+        }
+        QueueIterator operator++(int) {
+            QueueIterator old = *this;
+            ++*this;
+            return old;
+        }
+        bool operator==(const QueueIterator& other) const {
+            return this->h_ == other.h_;
+        }
+
+      private:
+        const PassengerPool* pool_ = nullptr;
+        PassengerHandle h_ = NO_PASSENGER;
+        QueueLane lane_ = QueueLane::MAIN;
+    };
+
+    struct QueueRange {
+        QueueIterator first;
+        QueueIterator last;
+        QueueIterator begin() const {
+            return this->first;
+        }
+        QueueIterator end() const {
+            return this->last;
+        }
+    };
+
+    PassengerHandle create(PassengerId id, StationId origin, StationType destination);
+    void release(PassengerHandle h);
+
+    bool alive(PassengerHandle h) const {
+        return h < this->live_.size() && this->live_[h];
+    }
+    std::size_t size() const {
+        return this->size_;
+    }
+    // One past the largest handle handed out; the size for tables indexed by handle.
+    std::size_t handleBound() const {
+        return this->live_.size();
+    }
+
+    PassengerId id(PassengerHandle h) const {
+        return this->ids_[h];
+    }
+    StationType destination(PassengerHandle h) const {
+        return static_cast<StationType>(this->destinations_[h]);
+    }
+    PassengerState state(PassengerHandle h) const {
+        return this->states_[h];
+    }
+    PassengerState& state(PassengerHandle h) {
+        return this->states_[h];
+    }
+    // NO_STATION until the passenger has a planned hop.
+    StationId nextHop(PassengerHandle h) const {
+        return this->nextHops_[h];
+    }
+    StationId& nextHop(PassengerHandle h) {
+        return this->nextHops_[h];
+    }
+    // Ticks spent waiting at stations so far, over every wait of the trip.
+    std::uint32_t age(PassengerHandle h) const {
+        return this->_waiting(h) ? this->agingClock_ - this->waitClocks_[h] : this->waitClocks_[h];
+    }
+    // While waiting: agingClock() - age(h), the clock value the passenger would have started
+    // waiting at had all its waits been one. Fixed while it waits, so it orders a queue by age.
+    std::uint32_t waitingSince(PassengerHandle h) const {
+        return this->waitClocks_[h];
+    }
+    std::uint32_t agingClock() const {
+        return this->agingClock_;
+    }
+    // Ages every waiting passenger by one tick.
+    void advanceAgingClock() {
+        ++this->agingClock_;
+    }
+    // PassengerFSM calls these when a passenger leaves or rejoins a station queue; the age
+    // freezes while it rides and carries on from there at the next station.
+    void stopWaiting(PassengerHandle h) {
+        this->waitClocks_[h] = this->agingClock_ - this->waitClocks_[h];
+    }
+    void startWaiting(PassengerHandle h) {
+        this->waitClocks_[h] = this->agingClock_ - this->waitClocks_[h];
+    }
+    // Station id while WAITING or TRANSFERRING, train id while ON_TRAIN.
+    std::uint32_t location(PassengerHandle h) const {
+        return this->locations_[h];
+    }
+    std::uint32_t& location(PassengerHandle h) {
+        return this->locations_[h];
+    }
+    std::optional<StationId> station(PassengerHandle h) const;
+    std::optional<TrainId> train(PassengerHandle h) const;
+
+    StationId origin(PassengerHandle h) const {
+        return this->cold_[h].origin;
+    }
+    // 0 while not riding a line.
+    LineId currentLine(PassengerHandle h) const {
+        return this->cold_[h].currentLine;
+    }
+    LineId& currentLine(PassengerHandle h) {
+        return this->cold_[h].currentLine;
+    }
+    const std::vector<StationId>& route(PassengerHandle h) const {
+        return this->cold_[h].route;
+    }
+    std::vector<StationId>& route(PassengerHandle h) {
+        return this->cold_[h].route;
+    }
+    std::uint32_t routeIndex(PassengerHandle h) const {
+        return this->cold_[h].routeIndex;
+    }
+    std::uint32_t& routeIndex(PassengerHandle h) {
+        return this->cold_[h].routeIndex;
+    }
+    // routeLines(h)[i] carries route(h)[i] -> route(h)[i + 1].
+    const std::vector<LineId>& routeLines(PassengerHandle h) const {
+        return this->cold_[h].routeLines;
+    }
+    std::vector<LineId>& routeLines(PassengerHandle h) {
+        return this->cold_[h].routeLines;
+    }
+    // Line to ride out of the current stop; ANY_LINE without a committed route.
+    LineId plannedLine(PassengerHandle h) const {
+        const Cold& cold = this->cold_[h];
+        return cold.routeIndex < cold.routeLines.size() ? cold.routeLines[cold.routeIndex]
+                                                        : ANY_LINE;
+    }
+    void dropRoute(PassengerHandle h);
+    void dropAllRoutes();
+
+    void pushBack(PassengerQueue& q, PassengerHandle h, QueueLane lane = QueueLane::MAIN);
+    void unlink(PassengerQueue& q, PassengerHandle h, QueueLane lane = QueueLane::MAIN);
+    // Next handle in the same queue, NO_PASSENGER at the tail.
+    PassengerHandle next(PassengerHandle h, QueueLane lane = QueueLane::MAIN) const {
+        return this->_links(lane)[h].next;
+    }
+    // Range-for over a queue in arrival order. Unlinking the current element invalidates it;
+    // read next() first when removing while walking.
+    QueueRange members(const PassengerQueue& q, QueueLane lane = QueueLane::MAIN) const {
+        return {QueueIterator(this, q.head, lane), QueueIterator(this, NO_PASSENGER, lane)};
+    }
+
+    void print(std::ostream& os, PassengerHandle h) const;
+
+  private:
+    bool _waiting(PassengerHandle h) const {
+        PassengerState s = this->states_[h];
+        return s == PassengerState::WAITING || s == PassengerState::TRANSFERRING;
+    }
+
+    struct Links {
+        PassengerHandle prev = NO_PASSENGER;
+        PassengerHandle next = NO_PASSENGER;
+    };
+
+    std::vector<Links>& _links(QueueLane lane) {
+        return this->links_[static_cast<std::size_t>(lane)];
+    }
+    const std::vector<Links>& _links(QueueLane lane) const {
+        return this->links_[static_cast<std::size_t>(lane)];
+    }
+
+    struct Cold {
+        StationId origin = NO_STATION;
+        LineId currentLine = 0;
+        std::uint32_t routeIndex = 0;
+        std::vector<StationId> route; // committed route, route[routeIndex] is the current stop
+        std::vector<LineId> routeLines;
+    };
+
+    std::vector<PassengerId> ids_;
+    std::vector<std::uint8_t> destinations_;
+    std::vector<PassengerState> states_;
+    std::vector<StationId> nextHops_;
+    std::vector<std::uint32_t> waitClocks_; // waitingSince while waiting, else the frozen age
+    std::vector<std::uint32_t> locations_;
+    std::array<std::vector<Links>, 2> links_;
+    std::vector<Cold> cold_;
+
+    std::vector<std::uint8_t> live_;
+    std::vector<PassengerHandle> free_;
+    std::size_t size_ = 0;
+    std::uint32_t agingClock_ = 0;
+};
@@ -4,50 +4,53 @@
 #include <stdexcept>
 #include <string>
 
-void PassengerFSM::waitingToOnTrain(Passenger& p, TrainId id) {
-    if (p.state != PassengerState::WAITING || p.train.has_value()) {
-        std::cerr << p << std::endl;
+void PassengerFSM::waitingToOnTrain(PassengerPool& pool, PassengerHandle h, TrainId id) {
+    if (pool.state(h) != PassengerState::WAITING) {
+        pool.print(std::cerr, h);
+        std::cerr << std::endl;
         throw std::logic_error("Passenger State Invalid Waiting->OnTrain: " +
-                               std::to_string(p.passengerId));
+                               std::to_string(pool.id(h)));
     }
 
-    p.state = PassengerState::ON_TRAIN;
-    p.train = id;
-    p.station.reset();
+    pool.state(h) = PassengerState::ON_TRAIN;
+    pool.location(h) = id;
+    pool.stopWaiting(h);
 }
 
-void PassengerFSM::onTrainToCompleted(Passenger& p) {
-    if (p.state != PassengerState::ON_TRAIN || !p.train.has_value()) {
-        std::cerr << p << std::endl;
+void PassengerFSM::onTrainToCompleted(PassengerPool& pool, PassengerHandle h) {
+    if (pool.state(h) != PassengerState::ON_TRAIN) {
+        pool.print(std::cerr, h);
+        std::cerr << std::endl;
         throw std::logic_error("Passenger State Invalid OnTrain->Completed: " +
-                               std::to_string(p.passengerId));
+                               std::to_string(pool.id(h)));
     }
 
-    p.state = PassengerState::COMPLETED;
-    p.train.reset();
-    p.station.reset();
+    pool.state(h) = PassengerState::COMPLETED;
+    pool.location(h) = 0;
 }
 
-void PassengerFSM::onTrainToTransferring(Passenger& p, StationId id) {
-    if (p.state != PassengerState::ON_TRAIN || !p.train.has_value()) {
-        std::cerr << p << std::endl;
+void PassengerFSM::onTrainToTransferring(PassengerPool& pool, PassengerHandle h, StationId id) {
+    if (pool.state(h) != PassengerState::ON_TRAIN) {
+        pool.print(std::cerr, h);
+        std::cerr << std::endl;
         throw std::logic_error("Passenger State Invalid OnTrain->Transferring: " +
-                               std::to_string(p.passengerId));
+                               std::to_string(pool.id(h)));
     }
 
-    p.state = PassengerState::TRANSFERRING;
-    p.train.reset();
-    p.station = id;
+    pool.state(h) = PassengerState::TRANSFERRING;
+    pool.location(h) = id;
+    pool.startWaiting(h);
 }
 
-void PassengerFSM::transferringToOnTrain(Passenger& p, TrainId id) {
-    if (p.state != PassengerState::TRANSFERRING || p.train.has_value()) {
-        std::cerr << p << std::endl;
+void PassengerFSM::transferringToOnTrain(PassengerPool& pool, PassengerHandle h, TrainId id) {
+    if (pool.state(h) != PassengerState::TRANSFERRING) {
+        pool.print(std::cerr, h);
+        std::cerr << std::endl;
         throw std::logic_error("Passenger State Invalid Transferring->OnTrain: " +
-                               std::to_string(p.passengerId));
+                               std::to_string(pool.id(h)));
     }
 
-    p.state = PassengerState::ON_TRAIN;
-    p.train = id;
-    p.station.reset();
+    pool.state(h) = PassengerState::ON_TRAIN;
+    pool.location(h) = id;
+    pool.stopWaiting(h);
 }
@@ -1,10 +1,10 @@
 #pragma once
-#include "Passenger.hpp"
+#include "passenger_pool.hpp"
 
 class PassengerFSM {
   public:
-    static void waitingToOnTrain(Passenger&, TrainId);
-    static void onTrainToTransferring(Passenger&, StationId);
-    static void transferringToOnTrain(Passenger&, TrainId);
-    static void onTrainToCompleted(Passenger&);
+    static void waitingToOnTrain(PassengerPool&, PassengerHandle, TrainId);
+    static void onTrainToTransferring(PassengerPool&, PassengerHandle, StationId);
+    static void transferringToOnTrain(PassengerPool&, PassengerHandle, TrainId);
+    static void onTrainToCompleted(PassengerPool&, PassengerHandle);
 };
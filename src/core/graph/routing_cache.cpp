@@ -2,20 +2,175 @@
 #include "Graph.hpp"
 #include "StationType.hpp"
 #include "id.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
 
-const RouteInfo& RoutingCache::get(StationId source, StationType destination, const Graph& graph) {
-    RouteKey key = {source, destination};
-    auto it = cache_.find(key);
-    if (it != cache_.end()) {
-        return it->second;
+namespace {
+
+// Lookups made by this thread during concurrent reads and not yet flushed.
+thread_local std::uint64_t threadHits = 0;
+
+} // namespace
+
+const RouteEntry& RoutingCache::get(StationId source, StationType destination, const Graph& graph) {
+    if (this->concurrentReads_) {
+        ++threadHits;
+    } else if (this->dirty_) {
+        this->_rebuild(graph);
+        ++this->stats_.misses;
+    } else if (!this->dirtyStations_.empty()) {
+        this->_refreshRegion(graph);
+        ++this->stats_.misses;
+    } else {
+        ++this->stats_.hits;
     }
+    if (slotIndex(source) >= this->table_.size() || !graph.stationExists(source)) {
+        throw std::logic_error("Invalid station id in RoutingCache::get");
+    }
+    return this->table_[slotIndex(source)][destination];
+}
 
-    RouteInfo info = graph.computeRoute(source, destination);
+void RoutingCache::stationAdded(StationId id, StationType type) {
+    // An isolated station cannot change anyone else's route; it only needs its own row.
+    const std::uint32_t slot = slotIndex(id);
+    if (slot >= this->table_.size()) {
+        this->table_.resize(slot + 1, Row{});
+    }
+    this->table_[slot] = Row{};
+    this->table_[slot][type].distance = 0;
+}
+
+void RoutingCache::stationRemoved(StationId id) {
+    if (slotIndex(id) < this->table_.size()) {
+        this->table_[slotIndex(id)] = Row{};
+    }
+}
 
-    auto [insertedIt, _] = cache_.emplace(key, std::move(info));
-    return insertedIt->second;
+void RoutingCache::invalidateAround(std::span<const StationId> stations) {
+    if (this->dirty_) {
+        return; // a full rebuild is already pending
+    }
+    this->dirtyStations_.insert(this->dirtyStations_.end(), stations.begin(), stations.end());
 }
 
 void RoutingCache::invalidate() {
-    cache_.clear();
+    this->dirty_ = true;
+    this->dirtyStations_.clear();
+}
+
+void RoutingCache::beginConcurrentReads(const Graph& graph) {
+    if (this->dirty_) {
+        this->_rebuild(graph);
+        ++this->stats_.misses;
+    } else if (!this->dirtyStations_.empty()) {
+        this->_refreshRegion(graph);
+        ++this->stats_.misses;
+    }
+    this->concurrentHits_.store(0, std::memory_order_relaxed);
+    this->concurrentReads_ = true;
+}
+
+void RoutingCache::flushConcurrentHits() {
+    this->concurrentHits_.fetch_add(std::exchange(threadHits, 0), std::memory_order_relaxed);
+}
+
+void RoutingCache::endConcurrentReads() {
+    this->concurrentReads_ = false;
+    this->stats_.hits += this->concurrentHits_.load(std::memory_order_relaxed);
+}
+
+const RoutingCacheStats& RoutingCache::stats() const {
+    return this->stats_;
+}
+
+void RoutingCache::_rebuild(const Graph& graph) {
+    this->stats_.invalidatedEntries += this->table_.size() * StationType::COUNT;
+    this->table_.assign(graph.stations_.indexBound(), Row{});
+
+    for (int type = 0; type < StationType::COUNT; ++type) {
+        // Seed in slot order so tie-breaking is deterministic.
+        this->queue_.clear();
+        for (auto&& [id, station] : graph.stations_) {
+            if (station.type == type) {
+                this->table_[slotIndex(id)][type].distance = 0;
+                this->queue_.push_back(id);
+            }
+        }
+        this->_bfs(type, graph);
+        ++this->stats_.typeRebuilds;
+    }
+
+    this->dirtyStations_.clear();
+    this->dirty_ = false;
+}
+
+void RoutingCache::_refreshRegion(const Graph& graph) {
+    const AdjacencyIndex& adjacency = graph.adjacency();
+    if (this->regionMark_.size() < this->table_.size()) {
+        this->regionMark_.resize(this->table_.size(), 0);
+    }
+    const std::uint32_t stamp = ++this->regionStamp_;
+
+    // Flood the components that now contain an edited station.
+    std::vector<StationId> region;
+    for (StationId seed : this->dirtyStations_) {
+        if (!graph.stationExists(seed) || this->regionMark_[slotIndex(seed)] == stamp) {
+            continue;
+        }
+        this->regionMark_[slotIndex(seed)] = stamp;
+        region.push_back(seed);
+        for (std::size_t head = region.size() - 1; head < region.size(); ++head) {
+            for (StationId n : adjacency.neighbours(region[head])) {
+                if (this->regionMark_[slotIndex(n)] != stamp) {
+                    this->regionMark_[slotIndex(n)] = stamp;
+                    region.push_back(n);
+                }
+            }
+        }
+    }
+    this->dirtyStations_.clear();
+    std::sort(region.begin(), region.end(),
+              [](StationId a, StationId b) { return slotIndex(a) < slotIndex(b); });
+
+    for (int type = 0; type < StationType::COUNT; ++type) {
+        bool hasSource = false;
+        bool hadRoute = false;
+        for (StationId id : region) {
+            hasSource = hasSource || graph.getStation(id)->type == type;
+            hadRoute = hadRoute || this->table_[slotIndex(id)][type].reachable();
+        }
+        if (!hasSource && !hadRoute) {
+            continue; // unreachable before and after the edit
+        }
+
+        this->queue_.clear();
+        for (StationId id : region) {
+            RouteEntry& entry = this->table_[slotIndex(id)][type];
+            entry = RouteEntry{};
+            if (graph.getStation(id)->type == type) {
+                entry.distance = 0;
+                this->queue_.push_back(id);
+            }
+        }
+        this->stats_.invalidatedEntries += region.size();
+        ++this->stats_.typeRebuilds;
+        this->_bfs(type, graph);
+    }
+}
+
+void RoutingCache::_bfs(int type, const Graph& graph) {
+    const AdjacencyIndex& adjacency = graph.adjacency();
+    for (std::size_t head = 0; head < this->queue_.size(); ++head) {
+        StationId cur = this->queue_[head];
+        const std::uint32_t next = this->table_[slotIndex(cur)][type].distance + 1;
+        for (StationId n : adjacency.neighbours(cur)) {
+            RouteEntry& entry = this->table_[slotIndex(n)][type];
+            if (entry.distance == RouteEntry::UNREACHABLE) {
+                entry.distance = next;
+                entry.nextHop = cur;
+                this->queue_.push_back(n);
+            }
+        }
+    }
 }
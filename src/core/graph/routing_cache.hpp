@@ -1,36 +1,75 @@
 #pragma once
 #include "StationType.hpp"
-#include "route_info.hpp"
-#include <unordered_map>
+#include "id.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <vector>
 
 class Graph;
 
-struct RouteKey {
-    StationId source;
-    StationType destination;
+struct RouteEntry {
+    static constexpr std::uint32_t UNREACHABLE = UINT32_MAX;
 
-    bool operator==(const RouteKey& other) const {
-        return source == other.source && destination == other.destination;
+    StationId nextHop = NO_STATION;
+    std::uint32_t distance = UNREACHABLE;
+
+    // A station of the destination type itself has distance 0 but nowhere to go.
+    bool reachable() const {
+        return nextHop != NO_STATION;
     }
 };
 
-namespace std {
-template <> struct hash<RouteKey> {
-    std::size_t operator()(const RouteKey& k) const {
-        std::size_t h1 = std::hash<StationId>{}(k.source);
-        std::size_t h2 = std::hash<StationType>{}(k.destination);
-
-        return h1 ^ (h2 + 0x9e3779b9 + (h1 << 6) + (h1 >> 2));
-    }
+struct RoutingCacheStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t invalidatedEntries = 0;
+    std::uint64_t typeRebuilds = 0;
 };
-} // namespace std
 
+// Dense next-hop/distance table indexed by [slotIndex(stationId)][StationType]. Rebuilt lazily
+// after a topology change by running one multi-source BFS per destination type, seeded from
+// every station of that type, so each lookup afterwards is a single array load.
+//
+// Edits report the stations whose edges changed. Only the connected components containing those
+// stations can see different routes, so the next lookup re-runs the BFS inside them alone, and
+// skips a destination type entirely when the components neither contain nor could reach it.
 class RoutingCache {
   public:
-    const RouteInfo& get(StationId source, StationType destination, const Graph& graph);
+    const RouteEntry& get(StationId source, StationType destination, const Graph& graph);
 
+    void stationAdded(StationId id, StationType type);
+    void stationRemoved(StationId id);
+    void invalidateAround(std::span<const StationId> stations);
     void invalidate();
 
+    // Brings the table up to date and lets get() be called from several threads until
+    // endConcurrentReads(), provided nothing invalidates it meanwhile. Hits in between are
+    // counted per thread; each task hands its own over with flushConcurrentHits() when it
+    // finishes, and they are added to stats() at the end.
+    void beginConcurrentReads(const Graph& graph);
+    void flushConcurrentHits();
+    void endConcurrentReads();
+
+    const RoutingCacheStats& stats() const;
+
   private:
-    std::unordered_map<RouteKey, RouteInfo> cache_;
+    using Row = std::array<RouteEntry, StationType::COUNT>;
+
+    void _rebuild(const Graph& graph);
+    void _refreshRegion(const Graph& graph);
+    void _bfs(int type, const Graph& graph);
+
+    bool dirty_ = true;
+    std::vector<Row> table_;
+    std::vector<StationId> dirtyStations_;
+
+    std::vector<StationId> queue_;
+    std::vector<std::uint32_t> regionMark_;
+    std::uint32_t regionStamp_ = 0;
+
+    RoutingCacheStats stats_;
+    bool concurrentReads_ = false;
+    std::atomic<std::uint64_t> concurrentHits_{0};
 };
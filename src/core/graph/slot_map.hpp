@@ -0,0 +1,154 @@
+#pragma once
+#include "id.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Contiguous storage addressed by generational ids (see id.hpp). Values live in one vector in
+// slot order, freed slots go on a free list, and iteration walks the slots in order, skipping
+// free ones, so it is deterministic and cache-friendly.
+template <typename T> class SlotMap {
+    template <bool Const> class Iterator {
+      public:
+        using Map = std::conditional_t<Const, const SlotMap, SlotMap>;
+        using Value = std::conditional_t<Const, const T, T>;
+        using value_type = std::pair<std::uint32_t, Value&>;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+
+        Iterator(Map* map, std::size_t slot) : map_(map), slot_(slot) {
+            this->_skipFree();
+        }
+        value_type operator*() const {
+            return {this->map_->_idOf(this->slot_), this->map_->values_[this->slot_]};
+        }
+        Iterator& operator++() {
+            ++this->slot_;
+            this->_skipFree();
+            return *this;
+        }
+        bool operator==(const Iterator& other) const {
+            return this->slot_ == other.slot_;
+        }
+
+      private:
+        void _skipFree() {
+            while (this->slot_ < this->map_->live_.size() && !this->map_->live_[this->slot_]) {
+                ++this->slot_;
+            }
+        }
+
+        Map* map_;
+        std::size_t slot_;
+    };
+
+  public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    // Id the next insert() will return.
+    std::uint32_t nextId() const {
+        if (!this->free_.empty()) {
+            return this->_idOf(this->free_.back());
+        }
+        if (this->values_.size() >= ID_SLOT_MASK) {
+            throw std::logic_error("SlotMap is full");
+        }
+        return this->_idOf(this->values_.size());
+    }
+
+    std::uint32_t insert(T value) {
+        std::uint32_t id = this->nextId();
+        std::size_t slot = slotIndex(id) - 1;
+        if (slot == this->values_.size()) {
+            this->values_.push_back(std::move(value));
+            this->generations_.push_back(0);
+            this->live_.push_back(1);
+        } else {
+            this->free_.pop_back();
+            this->values_[slot] = std::move(value);
+            this->live_[slot] = 1;
+        }
+        ++this->size_;
+        return id;
+    }
+
+    bool erase(std::uint32_t id) {
+        if (!this->contains(id)) {
+            return false;
+        }
+        std::size_t slot = slotIndex(id) - 1;
+        this->values_[slot] = T{};
+        this->live_[slot] = 0;
+        // Generations wrap after 2^(32 - ID_SLOT_BITS) reuses of one slot.
+        this->generations_[slot] = (this->generations_[slot] + 1) & (UINT32_MAX >> ID_SLOT_BITS);
+        this->free_.push_back(static_cast<std::uint32_t>(slot));
+        --this->size_;
+        return true;
+    }
+
+    bool contains(std::uint32_t id) const {
+        std::size_t index = slotIndex(id);
+        return index != 0 && index <= this->values_.size() && this->live_[index - 1] &&
+               this->_idOf(index - 1) == id;
+    }
+
+    T* find(std::uint32_t id) {
+        return this->contains(id) ? &this->values_[slotIndex(id) - 1] : nullptr;
+    }
+    const T* find(std::uint32_t id) const {
+        return this->contains(id) ? &this->values_[slotIndex(id) - 1] : nullptr;
+    }
+
+    T& at(std::uint32_t id) {
+        if (!this->contains(id)) {
+            throw std::logic_error("Invalid id " + std::to_string(id));
+        }
+        return this->values_[slotIndex(id) - 1];
+    }
+    const T& at(std::uint32_t id) const {
+        return const_cast<SlotMap*>(this)->at(id);
+    }
+
+    std::size_t size() const {
+        return this->size_;
+    }
+    bool empty() const {
+        return this->size_ == 0;
+    }
+
+    // One past the largest slotIndex() handed out; the size for tables indexed by slotIndex().
+    std::size_t indexBound() const {
+        return this->values_.size() + 1;
+    }
+
+    iterator begin() {
+        return iterator(this, 0);
+    }
+    iterator end() {
+        return iterator(this, this->values_.size());
+    }
+    const_iterator begin() const {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const {
+        return const_iterator(this, this->values_.size());
+    }
+
+  private:
+    std::uint32_t _idOf(std::size_t slot) const {
+        std::uint32_t generation = slot < this->generations_.size() ? this->generations_[slot] : 0;
+        return (generation << ID_SLOT_BITS) | static_cast<std::uint32_t>(slot + 1);
+    }
+
+    std::vector<T> values_;
+    std::vector<std::uint32_t> generations_;
+    std::vector<std::uint8_t> live_;
+    std::vector<std::uint32_t> free_;
+    std::size_t size_ = 0;
+};
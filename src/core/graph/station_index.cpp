@@ -0,0 +1,37 @@
+#include "station_index.hpp"
+#include <stdexcept>
+
+void StationIndex::add(StationId id, StationType type) {
+    const std::uint32_t slot = slotIndex(id);
+    if (slot >= this->positions_.size()) {
+        this->positions_.resize(slot + 1, NO_POSITION);
+    }
+    if (this->positions_[slot] != NO_POSITION) {
+        throw std::logic_error("Station slot already indexed");
+    }
+    this->positions_[slot] = static_cast<std::uint32_t>(this->ids_.size());
+    this->ids_.push_back(id);
+    ++this->counts_[type];
+    this->typeMask_ |= 1u << type;
+}
+
+void StationIndex::remove(StationId id, StationType type) {
+    if (!this->contains(id)) {
+        throw std::logic_error("Station not indexed");
+    }
+    const std::uint32_t position = this->positions_[slotIndex(id)];
+    const StationId last = this->ids_.back();
+    this->ids_[position] = last;
+    this->positions_[slotIndex(last)] = position;
+    this->ids_.pop_back();
+    this->positions_[slotIndex(id)] = NO_POSITION;
+    if (--this->counts_[type] == 0) {
+        this->typeMask_ &= ~(1u << type);
+    }
+}
+
+bool StationIndex::contains(StationId id) const {
+    const std::uint32_t slot = slotIndex(id);
+    return slot < this->positions_.size() && this->positions_[slot] != NO_POSITION &&
+           this->ids_[this->positions_[slot]] == id;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "StationType.hpp"
+#include "id.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Live station ids in one dense array plus a count per station type, updated as stations are
+// added and removed. Picking a random station is one array load and the set of types present is
+// a bitmask, however many stations and passengers there are. Removal moves the last id into
+// the freed position, so the order is insertion order until the first removal.
+class StationIndex {
+  public:
+    void add(StationId id, StationType type);
+    void remove(StationId id, StationType type);
+
+    bool contains(StationId id) const;
+    std::size_t size() const {
+        return this->ids_.size();
+    }
+    std::span<const StationId> ids() const {
+        return this->ids_;
+    }
+    std::uint32_t count(StationType type) const {
+        return this->counts_[type];
+    }
+    // Bit `type` is set while at least one station of that type exists.
+    std::uint32_t typeMask() const {
+        return this->typeMask_;
+    }
+
+  private:
+    static constexpr std::uint32_t NO_POSITION = UINT32_MAX;
+
+    std::vector<StationId> ids_;
+    std::vector<std::uint32_t> positions_; // by slotIndex, position in ids_
+    std::array<std::uint32_t, StationType::COUNT> counts_{};
+    std::uint32_t typeMask_ = 0;
+};
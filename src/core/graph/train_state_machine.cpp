@@ -1,12 +1,12 @@
 #include "train_state_machine.hpp"
 #include "Train.hpp"
-#include <iostream>
+#include "core/utils/Logger.hpp"
 #include <stdexcept>
 #include <string>
 
 void TrainFSM::idleToAlighting(Train& t) {
-    std::cout << "Transitioning Train " << t.trainId << " from IDLE to ALIGHTING "
-              << t.currentStationId << " " << t.nextStationId << std::endl;
+    METRO_LOG(DEBUG, TRAIN, "Transitioning Train ", t.trainId, " from IDLE to ALIGHTING ",
+              t.currentStationId, " ", t.nextStationId);
     if (t.state != TrainState::IDLE) {
         throw std::logic_error("Invalid Train State in IDLE->ALIGHTING " +
                                std::to_string(t.trainId));
@@ -16,8 +16,8 @@ void TrainFSM::idleToAlighting(Train& t) {
 }
 
 void TrainFSM::movingToAlighting(Train& t) {
-    std::cout << "Transitioning Train " << t.trainId << " from MOVING to ALIGHTING "
-              << t.currentStationId << " " << t.nextStationId << std::endl;
+    METRO_LOG(DEBUG, TRAIN, "Transitioning Train ", t.trainId, " from MOVING to ALIGHTING ",
+              t.currentStationId, " ", t.nextStationId);
     if (t.state != TrainState::MOVING || t.progress < 1.0f) {
         throw std::logic_error("Invalid Train State in MOVING->ALIGHTING " +
                                std::to_string(t.trainId));
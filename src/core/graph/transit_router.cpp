@@ -0,0 +1,110 @@
+#include "transit_router.hpp"
+#include "Graph.hpp"
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+
+namespace {
+
+constexpr LineId NO_LINE = 0;
+constexpr std::uint32_t NO_STATE = UINT32_MAX;
+
+struct State {
+    StationId station;
+    LineId line; // line the station was reached on
+    float cost;
+    std::uint32_t parent;
+    bool settled = false;
+};
+
+std::uint64_t stateKey(StationId station, LineId line) {
+    return (static_cast<std::uint64_t>(station) << 32) | line;
+}
+
+} // namespace
+
+CommittedRoute TransitRouter::route(StationId source, StationType destination, const Graph& graph,
+                                    const RouteCosts& costs) const {
+    const Station* origin = graph.getStation(source);
+    if (origin == nullptr) {
+        throw std::logic_error("Invalid station id in TransitRouter::route");
+    }
+    CommittedRoute result;
+    if (origin->type == destination) {
+        return result; // already there; no movement
+    }
+
+    const AdjacencyIndex& adjacency = graph.adjacency();
+    std::vector<State> states;
+    std::unordered_map<std::uint64_t, std::uint32_t> index;
+
+    // (cost, insertion order) keeps tie-breaking deterministic.
+    using Entry = std::tuple<float, std::uint32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+    states.push_back({source, NO_LINE, 0.0f, NO_STATE});
+    index.emplace(stateKey(source, NO_LINE), 0);
+    open.emplace(0.0f, 0);
+
+    std::uint32_t goal = NO_STATE;
+    while (!open.empty()) {
+        auto [cost, cur] = open.top();
+        open.pop();
+        if (states[cur].settled) {
+            continue;
+        }
+        states[cur].settled = true;
+
+        const StationId at = states[cur].station;
+        if (at != source && graph.getStation(at)->type == destination) {
+            goal = cur;
+            break;
+        }
+
+        auto neighbours = adjacency.neighbours(at);
+        auto lines = adjacency.edgeLines(at);
+        for (std::size_t i = 0; i < neighbours.size(); ++i) {
+            const LineId arrivedOn = states[cur].line;
+            float next = cost + costs.hop + costs.length * graph.edgeLength(at, neighbours[i]);
+            if (arrivedOn != NO_LINE && arrivedOn != lines[i]) {
+                next += costs.transfer;
+            }
+
+            auto [it, inserted] = index.try_emplace(stateKey(neighbours[i], lines[i]),
+                                                    static_cast<std::uint32_t>(states.size()));
+            if (inserted) {
+                states.push_back({neighbours[i], lines[i], next, cur});
+            } else if (states[it->second].settled || states[it->second].cost <= next) {
+                continue;
+            } else {
+                states[it->second].cost = next;
+                states[it->second].parent = cur;
+            }
+            open.emplace(next, it->second);
+        }
+    }
+
+    if (goal == NO_STATE) {
+        return result;
+    }
+
+    for (std::uint32_t s = goal; s != NO_STATE; s = states[s].parent) {
+        result.stations.push_back(states[s].station);
+        if (states[s].parent != NO_STATE) {
+            result.lines.push_back(states[s].line);
+        }
+    }
+    std::reverse(result.stations.begin(), result.stations.end());
+    std::reverse(result.lines.begin(), result.lines.end());
+    for (std::size_t i = 1; i < result.lines.size(); ++i) {
+        if (result.lines[i] != result.lines[i - 1]) {
+            ++result.transfers;
+        }
+    }
+    result.cost = states[goal].cost;
+    result.reachable = true;
+    return result;
+}
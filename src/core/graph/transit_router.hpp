@@ -0,0 +1,30 @@
+#pragma once
+#include "StationType.hpp"
+#include "id.hpp"
+#include <cstdint>
+#include <vector>
+
+class Graph;
+
+struct RouteCosts {
+    float hop = 1.0f;      // per station-to-station ride
+    float transfer = 2.0f; // per change of line at a station
+    float length = 0.0f;   // per unit of track length (Polyline::totalLength)
+};
+
+struct CommittedRoute {
+    bool reachable = false;
+    std::vector<StationId> stations; // stations[0] is the origin
+    std::vector<LineId> lines;       // lines[i] carries stations[i] -> stations[i + 1]
+    std::size_t transfers = 0;
+    float cost = 0.0f;
+};
+
+// Dijkstra over (station, line) states, so a change of line costs RouteCosts::transfer on top of
+// the per-hop and per-length costs. The search stops at the cheapest station of the destination
+// type.
+class TransitRouter {
+  public:
+    CommittedRoute route(StationId source, StationType destination, const Graph& graph,
+                         const RouteCosts& costs) const;
+};
@@ -0,0 +1,99 @@
+#include "core/simulation/CommandScript.hpp"
+#include "core/utils/utils.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+std::runtime_error scriptError(std::size_t lineNo, const std::string& what) {
+    return std::runtime_error("Command script line " + std::to_string(lineNo) + ": " + what);
+}
+
+template <typename T> T readField(std::istringstream& in, std::size_t lineNo, const char* name) {
+    T value;
+    if (!(in >> value)) {
+        throw scriptError(lineNo, std::string("expected ") + name);
+    }
+    return value;
+}
+
+} // namespace
+
+std::vector<ScheduledCommand> CommandScript::parse(std::istream& in) {
+    std::vector<ScheduledCommand> commands;
+    std::string raw;
+    std::size_t lineNo = 0;
+
+    while (std::getline(in, raw)) {
+        ++lineNo;
+        raw = raw.substr(0, raw.find('#'));
+        std::istringstream line(raw);
+        std::string word;
+        if (!(line >> word)) {
+            continue;
+        }
+
+        std::uint64_t tick = 0;
+        if (word[0] == '@') {
+            try {
+                tick = std::stoull(word.substr(1));
+            } catch (const std::exception&) {
+                throw scriptError(lineNo, "bad tick '" + word + "'");
+            }
+            if (!(line >> word)) {
+                throw scriptError(lineNo, "missing command after tick");
+            }
+        }
+
+        SimulationCommand cmd;
+        if (word == "station") {
+            float x = readField<float>(line, lineNo, "x");
+            float y = readField<float>(line, lineNo, "y");
+            std::string type = readField<std::string>(line, lineNo, "station type");
+            cmd = AddStationCmd{x, y, stringToType(type)};
+        } else if (word == "line") {
+            cmd = AddLineCmd{};
+        } else if (word == "connect") {
+            AddStationToLineCmd c{};
+            c.lineId = readField<std::uint32_t>(line, lineNo, "line id");
+            c.stationId = readField<std::uint32_t>(line, lineNo, "station id");
+            c.startStationId = readField<std::uint32_t>(line, lineNo, "start station id");
+            c.index = SIZE_MAX;
+            std::string index;
+            if (line >> index && index != "end") {
+                try {
+                    c.index = std::stoull(index);
+                } catch (const std::exception&) {
+                    throw scriptError(lineNo, "bad index '" + index + "'");
+                }
+            }
+            cmd = c;
+        } else if (word == "train") {
+            cmd = AddTrainToLineCmd{readField<std::uint32_t>(line, lineNo, "line id")};
+        } else if (word == "passenger") {
+            std::uint32_t station = readField<std::uint32_t>(line, lineNo, "station id");
+            std::string type = readField<std::string>(line, lineNo, "destination type");
+            cmd = AddPassengerCmd{station, stringToType(type)};
+        } else {
+            throw scriptError(lineNo, "unknown command '" + word + "'");
+        }
+        commands.push_back({tick, cmd});
+    }
+
+    std::stable_sort(commands.begin(), commands.end(),
+                     [](const ScheduledCommand& a, const ScheduledCommand& b) {
+                         return a.tick < b.tick;
+                     });
+    return commands;
+}
+
+std::vector<ScheduledCommand> CommandScript::load(const std::string& path) {
+    std::ifstream f(path);
+    if (!f.is_open()) {
+        throw std::runtime_error("Could not open command script: " + path);
+    }
+    return parse(f);
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "core/simulation/SimulationCommand.hpp"
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+struct ScheduledCommand {
+    std::uint64_t tick; // applied before the first step that reaches this tick count
+    SimulationCommand command;
+};
+
+// Plain-text command scripts for headless runs. One command per line, '#' starts a comment and
+// an optional "@<tick>" prefix delays the command until that tick (default 0):
+//
+//   station <x> <y> <CIRCLE|SQUARE|TRIANGLE|STAR>
+//   line
+//   connect <lineId> <stationId> <startStationId|0> [index|end]
+//   train <lineId>
+//   passenger <stationId> <TYPE>
+//
+// Commands are returned sorted by tick, keeping file order within a tick.
+class CommandScript {
+  public:
+    static std::vector<ScheduledCommand> parse(std::istream& in);
+    static std::vector<ScheduledCommand> load(const std::string& path);
+};
@@ -0,0 +1,32 @@
+#include "core/simulation/LevelSetup.hpp"
+#include "core/simulation/SimulationCommand.hpp"
+#include "core/utils/utils.hpp"
+
+void applyLevel(Simulation& sim, const LevelConfig& cfg) {
+    for (const auto& [id, pair] : cfg.geography) {
+        sim.addRiver(pair.second, pair.first);
+    }
+    for (const auto& st : cfg.initialStations) {
+        sim.enqueueCommand(AddStationCmd{st.x, st.y, stringToType(st.type)});
+    }
+    for (std::size_t i = 0; i < cfg.initialLines.size(); ++i) {
+        sim.enqueueCommand(AddLineCmd{});
+    }
+
+    // Prebuilt lines refer to stations by index. On a fresh simulation ids are handed out in
+    // command order starting at 1, so station i becomes id i + 1 and line i becomes id i + 1.
+    sim.setAvailableBridges(cfg.bridges);
+    for (std::size_t i = 0; i < cfg.initialLines.size(); ++i) {
+        const auto& line = cfg.initialLines[i];
+        auto lineId = static_cast<std::uint32_t>(i + 1);
+        std::uint32_t previous = 0;
+        for (std::size_t k = 0; k < line.stations.size(); ++k) {
+            auto stationId = static_cast<std::uint32_t>(line.stations[k] + 1);
+            sim.enqueueCommand(AddStationToLineCmd{lineId, stationId, previous, k});
+            previous = stationId;
+        }
+        for (int t = 0; t < line.trains; ++t) {
+            sim.enqueueCommand(AddTrainToLineCmd{lineId});
+        }
+    }
+}
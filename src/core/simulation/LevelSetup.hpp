@@ -0,0 +1,7 @@
+#pragma once
+#include "core/simulation/Simulation.hpp"
+#include "core/utils/LevelLoader.hpp"
+
+// Adds a level's rivers and enqueues its initial stations and lines, the same way the in-game
+// screen starts a level. Lines that list their stations are also connected and given trains.
+void applyLevel(Simulation& sim, const LevelConfig& cfg);
@@ -0,0 +1,200 @@
+#include "core/simulation/MonteCarloSweep.hpp"
+#include "core/simulation/LevelSetup.hpp"
+#include "core/simulation/Simulation.hpp"
+#include "core/utils/ThreadPool.hpp"
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+namespace {
+
+// Nearest-rank percentile of an already sorted sample.
+template <typename T> T percentile(const std::vector<T>& sorted, double p) {
+    if (sorted.empty()) {
+        return T{};
+    }
+    std::size_t rank = static_cast<std::size_t>(p * static_cast<double>(sorted.size()) + 0.5);
+    return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+std::uint32_t histogramPercentile(const std::vector<std::uint64_t>& histogram,
+                                  std::uint64_t total, double p) {
+    if (total == 0) {
+        return 0;
+    }
+    auto rank = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(p * static_cast<double>(total) + 0.5));
+    std::uint64_t seen = 0;
+    for (std::size_t length = 0; length < histogram.size(); ++length) {
+        seen += histogram[length];
+        if (seen >= rank) {
+            return static_cast<std::uint32_t>(length);
+        }
+    }
+    return static_cast<std::uint32_t>(histogram.size() - 1);
+}
+
+PolicySummary summarize(BoardingPolicy policy, const std::vector<SweepRun>& runs) {
+    PolicySummary summary{.policy = policy};
+    std::vector<std::uint32_t> scores;
+    std::vector<std::uint64_t> failureTicks;
+    std::vector<std::uint64_t> histogram;
+
+    for (const auto& run : runs) {
+        if (run.policy != policy) {
+            continue;
+        }
+        ++summary.runs;
+        if (!run.error.empty()) {
+            ++summary.errors;
+            continue;
+        }
+        scores.push_back(run.outcome.completedPassengers);
+        if (run.outcome.failureTick) {
+            failureTicks.push_back(*run.outcome.failureTick);
+        }
+        if (histogram.size() < run.queueHistogram.size()) {
+            histogram.resize(run.queueHistogram.size(), 0);
+        }
+        for (std::size_t i = 0; i < run.queueHistogram.size(); ++i) {
+            histogram[i] += run.queueHistogram[i];
+        }
+    }
+
+    std::sort(scores.begin(), scores.end());
+    std::sort(failureTicks.begin(), failureTicks.end());
+    if (!scores.empty()) {
+        double total = 0.0;
+        for (auto s : scores) {
+            total += s;
+        }
+        summary.meanScore = total / static_cast<double>(scores.size());
+        summary.p50Score = percentile(scores, 0.5);
+        summary.p90Score = percentile(scores, 0.9);
+    }
+    summary.failures = failureTicks.size();
+    if (!failureTicks.empty()) {
+        double total = 0.0;
+        for (auto t : failureTicks) {
+            total += static_cast<double>(t);
+        }
+        summary.meanFailureTick = total / static_cast<double>(failureTicks.size());
+        summary.p50FailureTick = percentile(failureTicks, 0.5);
+    }
+
+    std::uint64_t samples = 0;
+    for (auto count : histogram) {
+        samples += count;
+    }
+    summary.queueP50 = histogramPercentile(histogram, samples, 0.5);
+    summary.queueP90 = histogramPercentile(histogram, samples, 0.9);
+    summary.queueP99 = histogramPercentile(histogram, samples, 0.99);
+    for (std::size_t length = histogram.size(); length > 0; --length) {
+        if (histogram[length - 1] > 0) {
+            summary.queueMax = static_cast<std::uint32_t>(length - 1);
+            break;
+        }
+    }
+    return summary;
+}
+
+} // namespace
+
+SweepRun MonteCarloSweep::runOne(const SweepConfig& cfg, std::uint64_t seed,
+                                 BoardingPolicy policy) {
+    SweepRun run{.seed = seed, .policy = policy};
+    std::vector<std::uint32_t> lengths;
+
+    Simulation sim(seed);
+    sim.setBoardingPolicy(policy);
+    try {
+        applyLevel(sim, cfg.level);
+        run.outcome = runScripted(sim, cfg.script, cfg.limits, [&](const Simulation& s) {
+            lengths.clear();
+            s.collectQueueLengths(lengths);
+            for (auto length : lengths) {
+                if (length >= run.queueHistogram.size()) {
+                    run.queueHistogram.resize(length + 1, 0);
+                }
+                ++run.queueHistogram[length];
+            }
+        });
+    } catch (const std::exception& e) {
+        run.error = e.what();
+        run.outcome.ticks = sim.tickCount();
+        run.outcome.completedPassengers = sim.completedPassengers();
+    }
+    return run;
+}
+
+SweepResult MonteCarloSweep::run(const SweepConfig& cfg) {
+    SweepResult result;
+    const std::size_t total = cfg.policies.size() * cfg.seeds.size();
+    result.runs.resize(total);
+
+    std::size_t threads = cfg.threads ? cfg.threads : std::thread::hardware_concurrency();
+    ThreadPool pool(std::min(std::max<std::size_t>(1, threads), std::max<std::size_t>(1, total)));
+    for (std::size_t i = 0; i < total; ++i) {
+        pool.submit([&cfg, &result, i] {
+            const auto policy = cfg.policies[i / cfg.seeds.size()];
+            const auto seed = cfg.seeds[i % cfg.seeds.size()];
+            result.runs[i] = runOne(cfg, seed, policy);
+        });
+    }
+    pool.wait();
+
+    for (auto policy : cfg.policies) {
+        result.summaries.push_back(summarize(policy, result.runs));
+    }
+    return result;
+}
+
+void MonteCarloSweep::writeSummaryCsv(std::ostream& out, const SweepResult& result) {
+    out << "policy,runs,errors,mean_score,p50_score,p90_score,failures,mean_failure_tick,"
+           "p50_failure_tick,queue_p50,queue_p90,queue_p99,queue_max\n";
+    for (const auto& s : result.summaries) {
+        out << policyName(s.policy) << ',' << s.runs << ',' << s.errors << ',' << s.meanScore
+            << ',' << s.p50Score << ',' << s.p90Score << ',' << s.failures << ','
+            << s.meanFailureTick << ',' << s.p50FailureTick << ',' << s.queueP50 << ','
+            << s.queueP90 << ',' << s.queueP99 << ',' << s.queueMax << '\n';
+    }
+}
+
+void MonteCarloSweep::writeRunsCsv(std::ostream& out, const SweepResult& result) {
+    out << "policy,seed,ticks,score,failure_tick,error\n";
+    for (const auto& r : result.runs) {
+        out << policyName(r.policy) << ',' << r.seed << ',' << r.outcome.ticks << ','
+            << r.outcome.completedPassengers << ',';
+        if (r.outcome.failureTick) {
+            out << *r.outcome.failureTick;
+        }
+        out << ',';
+        if (!r.error.empty()) {
+            std::string quoted = r.error;
+            std::replace(quoted.begin(), quoted.end(), '"', '\'');
+            out << '"' << quoted << '"';
+        }
+        out << '\n';
+    }
+}
+
+const char* MonteCarloSweep::policyName(BoardingPolicy policy) {
+    switch (policy) {
+    case FIFO:
+        return "FIFO";
+    case SHORTEST_REMAINING_HOPS:
+        return "SHORTEST_REMAINING_HOPS";
+    case AGING_PRIORITY:
+        return "AGING_PRIORITY";
+    }
+    return "UNKNOWN";
+}
+
+std::optional<BoardingPolicy> MonteCarloSweep::parsePolicy(const std::string& name) {
+    for (auto policy : {FIFO, SHORTEST_REMAINING_HOPS, AGING_PRIORITY}) {
+        if (name == policyName(policy)) {
+            return policy;
+        }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "core/graph/Graph.hpp"
+#include "core/simulation/CommandScript.hpp"
+#include "core/simulation/ScriptedRun.hpp"
+#include "core/utils/LevelLoader.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct SweepConfig {
+    LevelConfig level;
+    std::vector<ScheduledCommand> script;
+    std::vector<std::uint64_t> seeds;
+    std::vector<BoardingPolicy> policies;
+    RunLimits limits;
+    std::size_t threads = 0; // 0 uses the hardware concurrency
+};
+
+struct SweepRun {
+    std::uint64_t seed;
+    BoardingPolicy policy;
+    std::string error{}; // non-empty when the simulation threw
+    RunOutcome outcome{};
+    // queueHistogram[n] = number of (station, tick) samples with n passengers waiting
+    std::vector<std::uint64_t> queueHistogram{};
+};
+
+struct PolicySummary {
+    BoardingPolicy policy;
+    std::size_t runs = 0;
+    std::size_t errors = 0;
+    double meanScore = 0.0;
+    std::uint32_t p50Score = 0;
+    std::uint32_t p90Score = 0;
+    std::size_t failures = 0;
+    double meanFailureTick = 0.0;
+    std::uint64_t p50FailureTick = 0;
+    std::uint32_t queueP50 = 0;
+    std::uint32_t queueP90 = 0;
+    std::uint32_t queueP99 = 0;
+    std::uint32_t queueMax = 0;
+};
+
+struct SweepResult {
+    std::vector<SweepRun> runs; // grouped by policy, then seed, both in config order
+    std::vector<PolicySummary> summaries;
+};
+
+// Runs every (policy, seed) pair of a level on a work-stealing pool. Each task builds its own
+// Simulation from the shared read-only config and writes only its own result slot, so the
+// output is identical for any thread count.
+class MonteCarloSweep {
+  public:
+    static SweepRun runOne(const SweepConfig& cfg, std::uint64_t seed, BoardingPolicy policy);
+    static SweepResult run(const SweepConfig& cfg);
+
+    static void writeSummaryCsv(std::ostream& out, const SweepResult& result);
+    static void writeRunsCsv(std::ostream& out, const SweepResult& result);
+
+    static const char* policyName(BoardingPolicy policy);
+    static std::optional<BoardingPolicy> parsePolicy(const std::string& name);
+};
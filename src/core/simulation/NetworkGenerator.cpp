@@ -0,0 +1,194 @@
+#include "core/simulation/NetworkGenerator.hpp"
+#include "core/utils/utils.hpp"
+#include "core/world/WorldGeometry.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* const LINE_COLORS[] = {"#e74c3c", "#3498db", "#2ecc71", "#f1c40f", "#9b59b6",
+                                   "#e67e22", "#1abc9c", "#34495e", "#ff6b81", "#8e6e53"};
+
+struct Grid {
+    int cols;
+    int rows;
+    std::vector<int> station; // cell -> station index, -1 when empty
+};
+
+// Up to `length` stations, each within two cells of the previous one. The walk prefers to keep
+// its heading, and avoids stations other lines already serve unless an overlap roll allows it.
+std::vector<int> walkLine(const Grid& grid, const std::vector<int>& cellOf,
+                          const std::vector<int>& served, int start, int length, float overlap,
+                          std::mt19937_64& rng) {
+    std::vector<int> line{start};
+    std::vector<int> candidates;
+    std::vector<float> weights;
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    float headingX = unit(rng) - 0.5f;
+    float headingY = unit(rng) - 0.5f;
+
+    while (static_cast<int>(line.size()) < length) {
+        int cell = cellOf[line.back()];
+        int cx = cell % grid.cols;
+        int cy = cell / grid.cols;
+        bool allowServed = unit(rng) < overlap;
+
+        candidates.clear();
+        weights.clear();
+        for (int dy = -2; dy <= 2; ++dy) {
+            for (int dx = -2; dx <= 2; ++dx) {
+                int nx = cx + dx;
+                int ny = cy + dy;
+                if ((dx == 0 && dy == 0) || nx < 0 || ny < 0 || nx >= grid.cols ||
+                    ny >= grid.rows) {
+                    continue;
+                }
+                int next = grid.station[ny * grid.cols + nx];
+                if (next < 0 || std::find(line.begin(), line.end(), next) != line.end()) {
+                    continue;
+                }
+                float norm = std::sqrt(float(dx * dx + dy * dy));
+                float headingNorm = std::sqrt(headingX * headingX + headingY * headingY);
+                float alignment = headingNorm > 1e-6f
+                                      ? (dx * headingX + dy * headingY) / (norm * headingNorm)
+                                      : 0.0f;
+                float weight = (1.0f + alignment) * (1.0f + alignment) / norm + 0.01f;
+                if (served[next] > 0 && !allowServed) {
+                    weight *= 0.05f;
+                }
+                candidates.push_back(next);
+                weights.push_back(weight);
+            }
+        }
+        if (candidates.empty()) {
+            break;
+        }
+
+        std::discrete_distribution<std::size_t> pick(weights.begin(), weights.end());
+        int next = candidates[pick(rng)];
+        int nextCell = cellOf[next];
+        headingX = 0.7f * headingX + 0.3f * float(nextCell % grid.cols - cx);
+        headingY = 0.7f * headingY + 0.3f * float(nextCell / grid.cols - cy);
+        line.push_back(next);
+    }
+    return line;
+}
+
+} // namespace
+
+LevelConfig NetworkGenerator::generate(const NetworkGenParams& params) {
+    if (params.stations < 2 || params.lines < 0 || params.minLineLength < 2 ||
+        params.maxLineLength < params.minLineLength || params.spacing <= 0.0f) {
+        throw std::logic_error("Invalid network generator parameters");
+    }
+    std::mt19937_64 rng(params.seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    LevelConfig cfg;
+    cfg.id = params.levelId;
+    cfg.name = "Generated " + std::to_string(params.stations) + " stations (seed " +
+               std::to_string(params.seed) + ")";
+    cfg.seed = params.seed;
+    cfg.initialInterval = 2.0f;
+    cfg.rampRate = 0.0002f;
+    cfg.minInterval = 0.5f;
+    cfg.initialTrains = 3;
+
+    // A quarter of the cells stay empty so lines have to bend around gaps.
+    int cells = params.stations + params.stations / 4;
+    Grid grid;
+    grid.cols = static_cast<int>(std::ceil(std::sqrt(cells * 16.0 / 9.0)));
+    grid.rows = (cells + grid.cols - 1) / grid.cols;
+    grid.station.assign(static_cast<std::size_t>(grid.cols) * grid.rows, -1);
+
+    std::vector<int> order(grid.station.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), rng);
+    std::vector<int> cellOf(order.begin(), order.begin() + params.stations);
+    std::sort(cellOf.begin(), cellOf.end()); // row-major station order keeps neighbours close
+
+    std::discrete_distribution<int> typeDist(params.typeWeights.begin(),
+                                             params.typeWeights.end());
+    for (int i = 0; i < params.stations; ++i) {
+        int cell = cellOf[i];
+        grid.station[cell] = i;
+        float x = (float(cell % grid.cols) + 0.2f + 0.6f * unit(rng)) * params.spacing;
+        float y = (float(cell / grid.cols) + 0.2f + 0.6f * unit(rng)) * params.spacing;
+        auto type = static_cast<StationType>(typeDist(rng));
+        cfg.initialStations.push_back({x, y, typeToString(type), 0});
+    }
+
+    std::vector<int> served(params.stations, 0);
+    std::vector<int> servedList;
+    std::uniform_int_distribution<int> lengthDist(params.minLineLength, params.maxLineLength);
+    std::uniform_int_distribution<int> stationDist(0, params.stations - 1);
+    for (int l = 0; l < params.lines; ++l) {
+        int start = stationDist(rng);
+        if (!servedList.empty() && unit(rng) < params.overlap) {
+            start = servedList[std::uniform_int_distribution<std::size_t>(
+                0, servedList.size() - 1)(rng)];
+        } else {
+            for (int tries = 0; served[start] > 0 && tries < 16; ++tries) {
+                start = stationDist(rng);
+            }
+        }
+
+        auto stations = walkLine(grid, cellOf, served, start, lengthDist(rng), params.overlap, rng);
+        if (stations.size() < 2) {
+            continue;
+        }
+        for (int s : stations) {
+            if (served[s]++ == 0) {
+                servedList.push_back(s);
+            }
+        }
+        int id = static_cast<int>(cfg.initialLines.size());
+        cfg.initialLines.push_back({id, LINE_COLORS[id % std::size(LINE_COLORS)],
+                                    std::move(stations), params.trainsPerLine});
+    }
+
+    float width = grid.cols * params.spacing;
+    float height = grid.rows * params.spacing;
+    std::vector<std::vector<Vector2>> riverPoints;
+    for (int r = 0; r < params.rivers; ++r) {
+        bool horizontal = r % 2 == 0;
+        float across = horizontal ? width : height;
+        float span = horizontal ? height : width;
+        float offset = (0.15f + 0.7f * unit(rng)) * span;
+
+        std::vector<std::pair<float, float>> points;
+        std::vector<Vector2> vectors;
+        const int segments = 6;
+        for (int k = 0; k <= segments; ++k) {
+            float along = -params.spacing + (across + 2.0f * params.spacing) * k / segments;
+            float side = std::clamp(offset + (unit(rng) - 0.5f) * 0.2f * span, 0.0f, span);
+            auto point = horizontal ? std::make_pair(along, side) : std::make_pair(side, along);
+            points.push_back(point);
+            vectors.push_back({point.first, point.second});
+        }
+        cfg.geography[static_cast<std::uint32_t>(r + 1)] = {params.riverWidth, points};
+        riverPoints.push_back(std::move(vectors));
+    }
+
+    // Simulation spends one bridge on every line edge whose track crosses a river.
+    cfg.bridges = 0;
+    for (const auto& line : cfg.initialLines) {
+        for (std::size_t k = 1; k < line.stations.size(); ++k) {
+            const auto& a = cfg.initialStations[line.stations[k - 1]];
+            const auto& b = cfg.initialStations[line.stations[k]];
+            Polyline track = WorldGeometry::getOctilinearPath({a.x, a.y}, {b.x, b.y});
+            for (const auto& river : riverPoints) {
+                if (WorldGeometry::doesTrackNeedBridge(track.points, river)) {
+                    ++cfg.bridges;
+                    break;
+                }
+            }
+        }
+    }
+    return cfg;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "core/graph/StationType.hpp"
+#include "core/utils/LevelLoader.hpp"
+#include <array>
+#include <cstdint>
+
+struct NetworkGenParams {
+    std::uint64_t seed = 1;
+    int levelId = 100;
+    int stations = 2000;
+    float spacing = 80.0f; // grid cell size; stations are jittered inside their cell
+    std::array<float, StationType::COUNT> typeWeights = {0.55f, 0.25f, 0.15f, 0.05f};
+
+    int lines = 40;
+    int minLineLength = 8;
+    int maxLineLength = 40;
+    // Chance that a line starts at, or steps onto, a station another line already serves.
+    float overlap = 0.25f;
+    int trainsPerLine = 2;
+
+    int rivers = 2;
+    float riverWidth = 50.0f;
+};
+
+// Procedural LevelConfig for scaling runs. Stations sit on a jittered grid with the requested
+// type mix; lines are random walks between neighbouring stations; rivers are polylines across
+// the map and every line edge that crosses one is given a bridge. The result only depends on
+// the parameters, so a seed identifies a network.
+class NetworkGenerator {
+  public:
+    static LevelConfig generate(const NetworkGenParams& params);
+};
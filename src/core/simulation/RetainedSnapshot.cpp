@@ -0,0 +1,211 @@
+#include "RetainedSnapshot.hpp"
+#include "core/graph/id.hpp"
+#include "core/simulation/Simulation.hpp"
+#include <algorithm>
+
+namespace {
+
+constexpr std::uint32_t NO_POSITION = UINT32_MAX;
+
+std::pair<std::uint32_t, std::uint32_t> edgeKey(std::uint32_t a, std::uint32_t b) {
+    return {std::min(a, b), std::max(a, b)};
+}
+
+PassengerRange append(std::vector<PassengerView>& passengers,
+                      const std::vector<PassengerView>& more) {
+    PassengerRange range = {static_cast<std::uint32_t>(passengers.size()),
+                            static_cast<std::uint32_t>(more.size())};
+    passengers.insert(passengers.end(), more.begin(), more.end());
+    return range;
+}
+
+template <typename View> bool bySlot(const View& a, const View& b) {
+    return slotIndex(a.id) < slotIndex(b.id);
+}
+
+} // namespace
+
+const SimulationSnapshot& RetainedSnapshot::update(Simulation& sim) {
+    sim.changesSince(this->version_, this->delta_);
+    this->apply(this->delta_);
+    return this->snap_;
+}
+
+void RetainedSnapshot::apply(const SimulationDelta& delta) {
+    const GraphDelta& graph = delta.graph;
+    if (graph.full) {
+        this->_clear();
+    } else if (graph.agingClock != this->agingClock_) {
+        // Stations the delta leaves out still had their passengers waiting in the meantime.
+        const std::uint32_t elapsed = graph.agingClock - this->agingClock_;
+        for (const StationView& station : this->snap_.stations) {
+            for (PassengerView& p : this->stationPassengers_[slotIndex(station.id)]) {
+                p.age += elapsed;
+            }
+        }
+    }
+    this->snap_.tick = delta.tick;
+    this->snap_.score = graph.score;
+
+    this->_applyStations(graph);
+    for (const auto& [index, view] : graph.trains) {
+        if (index >= this->snap_.trains.size()) {
+            this->snap_.trains.resize(index + 1);
+            this->trainPassengers_.resize(index + 1);
+        }
+        this->snap_.trains[index] = view;
+        auto passengers = graph.passengersOf(view.passengers);
+        this->trainPassengers_[index].assign(passengers.begin(), passengers.end());
+    }
+    for (auto [index, progress] : graph.progress) {
+        this->snap_.trains[index].progress = progress;
+    }
+    this->_applyLines(graph);
+    this->_applyGeometry(delta);
+    for (const auto& [id, pos] : delta.trainPositions) {
+        this->snap_.trainPositions[id] = pos;
+    }
+
+    std::vector<PassengerView>& passengers = this->snap_.passengers;
+    passengers.clear();
+    for (StationView& station : this->snap_.stations) {
+        station.passengers = append(passengers, this->stationPassengers_[slotIndex(station.id)]);
+    }
+    for (std::size_t i = 0; i < this->snap_.trains.size(); ++i) {
+        this->snap_.trains[i].passengers = append(passengers, this->trainPassengers_[i]);
+    }
+
+    this->version_ = graph.version;
+    this->agingClock_ = graph.agingClock;
+}
+
+void RetainedSnapshot::_clear() {
+    this->snap_.stations.clear();
+    this->snap_.trains.clear();
+    this->snap_.passengers.clear();
+    this->snap_.lines.clear();
+    this->snap_.stationPositions.clear();
+    this->snap_.linePaths.clear();
+    this->snap_.edgePaths.clear();
+    this->snap_.trainPositions.clear();
+    this->stationAt_.clear();
+    this->stationPassengers_.clear();
+    this->trainPassengers_.clear();
+}
+
+void RetainedSnapshot::_applyStations(const GraphDelta& delta) {
+    std::vector<StationView>& stations = this->snap_.stations;
+    if (!delta.removedStations.empty()) {
+        std::erase_if(stations, [&](const StationView& s) {
+            return std::find(delta.removedStations.begin(), delta.removedStations.end(), s.id) !=
+                   delta.removedStations.end();
+        });
+        this->_indexStations();
+    }
+
+    bool sorted = true;
+    for (const StationView& view : delta.stations) {
+        const std::uint32_t slot = slotIndex(view.id);
+        if (slot >= this->stationPassengers_.size()) {
+            this->stationPassengers_.resize(slot + 1);
+        }
+        auto passengers = delta.passengersOf(view.passengers);
+        this->stationPassengers_[slot].assign(passengers.begin(), passengers.end());
+        if (slot < this->stationAt_.size() && this->stationAt_[slot] != NO_POSITION &&
+            stations[this->stationAt_[slot]].id == view.id) {
+            stations[this->stationAt_[slot]] = view;
+            continue;
+        }
+        sorted = sorted && (stations.empty() || slotIndex(stations.back().id) < slot);
+        if (slot >= this->stationAt_.size()) {
+            this->stationAt_.resize(slot + 1, NO_POSITION);
+        }
+        this->stationAt_[slot] = static_cast<std::uint32_t>(stations.size());
+        stations.push_back(view);
+    }
+    // Snapshots list stations in slot order; a reused slot lands in the middle.
+    if (!sorted) {
+        std::sort(stations.begin(), stations.end(), bySlot<StationView>);
+        this->_indexStations();
+    }
+}
+
+void RetainedSnapshot::_indexStations() {
+    this->stationAt_.assign(this->stationAt_.size(), NO_POSITION);
+    for (std::uint32_t i = 0; i < this->snap_.stations.size(); ++i) {
+        const std::uint32_t slot = slotIndex(this->snap_.stations[i].id);
+        if (slot >= this->stationAt_.size()) {
+            this->stationAt_.resize(slot + 1, NO_POSITION);
+        }
+        this->stationAt_[slot] = i;
+    }
+}
+
+void RetainedSnapshot::_applyLines(const GraphDelta& delta) {
+    std::vector<LineView>& lines = this->snap_.lines;
+    for (LineId id : delta.removedLines) {
+        std::erase_if(lines, [id](const LineView& line) { return line.id == id; });
+        this->snap_.linePaths.erase(id);
+    }
+    bool sorted = true;
+    for (const LineView& view : delta.lines) {
+        auto it = std::find_if(lines.begin(), lines.end(),
+                               [&](const LineView& line) { return line.id == view.id; });
+        if (it != lines.end()) {
+            *it = view;
+            continue;
+        }
+        sorted = sorted && (lines.empty() || slotIndex(lines.back().id) < slotIndex(view.id));
+        lines.push_back(view);
+    }
+    if (!sorted) {
+        std::sort(lines.begin(), lines.end(), bySlot<LineView>);
+    }
+}
+
+void RetainedSnapshot::_applyGeometry(const SimulationDelta& delta) {
+    for (StationId id : delta.graph.removedStations) {
+        this->snap_.stationPositions.erase(id);
+    }
+    for (const auto& [id, pos] : delta.stationPositions) {
+        this->snap_.stationPositions[id] = pos;
+    }
+    for (const auto& [key, path] : delta.edgePaths) {
+        this->snap_.edgePaths[key] = path;
+    }
+    const std::vector<LineView>& changed = delta.graph.lines;
+    if (changed.empty() && delta.edgePaths.empty()) {
+        return;
+    }
+
+    // A changed edge can also belong to lines that did not change themselves.
+    auto usesChangedEdge = [&](const LineView& line) {
+        for (std::size_t i = 0; i + 1 < line.stationIds.size(); ++i) {
+            auto key = edgeKey(line.stationIds[i], line.stationIds[i + 1]);
+            for (const auto& edge : delta.edgePaths) {
+                if (edge.first == key) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+    for (const LineView& line : this->snap_.lines) {
+        if (delta.graph.full ||
+            std::any_of(changed.begin(), changed.end(),
+                        [&](const LineView& c) { return c.id == line.id; }) ||
+            usesChangedEdge(line)) {
+            this->_rebuildLinePath(line);
+        }
+    }
+}
+
+void RetainedSnapshot::_rebuildLinePath(const LineView& line) {
+    this->snap_.linePaths.erase(line.id);
+    for (std::size_t i = 0; i + 1 < line.stationIds.size(); ++i) {
+        auto it = this->snap_.edgePaths.find(edgeKey(line.stationIds[i], line.stationIds[i + 1]));
+        if (it != this->snap_.edgePaths.end()) {
+            this->snap_.linePaths[line.id].push_back(it->second);
+        }
+    }
+}
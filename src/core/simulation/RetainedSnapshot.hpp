@@ -0,0 +1,41 @@
+#pragma once
+#include "core/simulation/SimulationSnapshot.hpp"
+#include <cstdint>
+#include <vector>
+
+class Simulation;
+
+// A SimulationSnapshot kept up to date from Simulation::changesSince, for readers that look at
+// the whole state every frame. Each update copies what changed since the previous one: the
+// queues of stations and trains that boarded, alighted or spawned passengers, the progress of
+// moving trains, and geometry only when stations or lines are edited. Equal to
+// Simulation::snapshot() after every update.
+class RetainedSnapshot {
+  public:
+    const SimulationSnapshot& update(Simulation& sim);
+    void apply(const SimulationDelta& delta);
+
+    const SimulationSnapshot& snapshot() const {
+        return this->snap_;
+    }
+    std::uint64_t version() const {
+        return this->version_;
+    }
+
+  private:
+    void _clear();
+    void _applyStations(const GraphDelta& delta);
+    void _applyLines(const GraphDelta& delta);
+    void _applyGeometry(const SimulationDelta& delta);
+    void _indexStations();
+    void _rebuildLinePath(const LineView& line);
+
+    SimulationSnapshot snap_{};
+    SimulationDelta delta_{}; // reused by update()
+    std::uint64_t version_ = 0;
+    std::uint32_t agingClock_ = 0;
+    std::vector<std::uint32_t> stationAt_; // by slotIndex, position in snap_.stations
+    // Queues kept per member and laid out into snap_.passengers after every update.
+    std::vector<std::vector<PassengerView>> stationPassengers_; // by slotIndex
+    std::vector<std::vector<PassengerView>> trainPassengers_;   // by train index
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include "core/simulation/CommandScript.hpp"
+#include "core/simulation/Simulation.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+struct RunLimits {
+    std::uint64_t ticks = 10000;
+    std::chrono::milliseconds frame{16};
+};
+
+struct RunOutcome {
+    std::uint64_t ticks = 0;
+    std::uint32_t completedPassengers = 0;
+    std::optional<std::uint64_t> failureTick;
+};
+
+// Steps sim with a fixed frame delta until limits.ticks ticks have run or the level fails,
+// feeding scheduled commands in before the step that reaches their tick. onTick(sim) runs after
+// every completed tick. Exceptions from the simulation propagate to the caller; a frame that is
+// not positive would never reach the next tick and throws std::logic_error.
+template <typename OnTick>
+RunOutcome runScripted(Simulation& sim, const std::vector<ScheduledCommand>& script,
+                       const RunLimits& limits, OnTick&& onTick) {
+    if (limits.frame.count() <= 0) {
+        throw std::logic_error("runScripted needs a positive frame delta");
+    }
+    RunOutcome outcome;
+    std::size_t nextCommand = 0;
+    while (sim.tickCount() < limits.ticks) {
+        while (nextCommand < script.size() && script[nextCommand].tick <= sim.tickCount()) {
+            sim.enqueueCommand(script[nextCommand++].command);
+        }
+        std::uint64_t before = sim.tickCount();
+        while (sim.tickCount() == before) {
+            sim.step(limits.frame);
+        }
+        onTick(static_cast<const Simulation&>(sim));
+        if (sim.isFailed()) {
+            outcome.failureTick = sim.tickCount();
+            break;
+        }
+    }
+    outcome.ticks = sim.tickCount();
+    outcome.completedPassengers = sim.completedPassengers();
+    return outcome;
+}
+
+inline RunOutcome runScripted(Simulation& sim, const std::vector<ScheduledCommand>& script,
+                              const RunLimits& limits) {
+    return runScripted(sim, script, limits, [](const Simulation&) {});
+}
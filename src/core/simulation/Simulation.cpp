@@ -2,14 +2,63 @@
 #include "core/graph/Graph.hpp"
 #include "core/graph/SimulationSnapshot.hpp"
 #include "core/graph/StationType.hpp"
+#include "core/utils/Logger.hpp"
+#include "core/utils/StateHash.hpp"
 #include "core/world/Polyline.hpp"
 #include "core/world/WorldGeometry.hpp"
+#include <algorithm>
+#include <array>
 #include <cstddef>
-#include <iostream>
+#include <map>
 #include <optional>
-#include <set>
+#include <span>
+#include <utility>
+
+namespace {
+
+std::uint64_t pathHash(std::uint64_t hash, const Polyline& path) {
+    for (const Vector2& p : path.points) {
+        hash = StateHash::fields(StateHash::WORLD_EDGE,
+                                 {hash, StateHash::bits(p.x), StateHash::bits(p.y)});
+    }
+    return StateHash::fields(StateHash::WORLD_EDGE,
+                             {hash, StateHash::bits(path.totalLength), path.bridge});
+}
+
+// Makes `dst` equal to `src`, keeping the nodes of keys both have.
+template <typename K, typename V> void assignMap(std::map<K, V>& dst, const std::map<K, V>& src) {
+    auto d = dst.begin();
+    for (const auto& [key, value] : src) {
+        while (d != dst.end() && d->first < key) {
+            d = dst.erase(d);
+        }
+        if (d != dst.end() && d->first == key) {
+            d->second = value;
+            ++d;
+        } else {
+            dst.emplace_hint(d, key, value);
+        }
+    }
+    dst.erase(d, dst.end());
+}
+
+// Writes the types set in `mask` to `out` in enum order and returns how many there are.
+std::size_t existingTypes(std::uint32_t mask, std::array<StationType, StationType::COUNT>& out) {
+    std::size_t count = 0;
+    for (int type = 0; type < StationType::COUNT; ++type) {
+        if (mask & (1u << type)) {
+            out[count++] = static_cast<StationType>(type);
+        }
+    }
+    return count;
+}
+
+} // namespace
 
 Simulation::Simulation(std::uint64_t seed) : seed_(seed), rng_(seed) {
+    graph_.setRoutingPolicy(RoutingPolicy::TRANSFER_AWARE);
+    graph_.setRouteCosts({.hop = 1.0f, .transfer = 2.0f, .length = 0.01f});
+    graph_.setTickScheduling(TickScheduling::EVENT_DRIVEN);
 }
 
 void Simulation::step(std::chrono::milliseconds dt) {
@@ -23,38 +72,40 @@ void Simulation::step(std::chrono::milliseconds dt) {
 
     // Accumulate time (converting dt to seconds)
     spawnAccumulator_ += (dt.count() / 1000.0f);
-    std::cout << "Tick: " << tickCount_ << ", SpawnAccumulator: " << spawnAccumulator_
-              << ", CurrentInterval: " << currentInterval << std::endl;
+    METRO_LOG(TRACE, SIMULATION, "Tick: ", tickCount_, ", SpawnAccumulator: ", spawnAccumulator_,
+              ", CurrentInterval: ", currentInterval);
 
     if (spawnAccumulator_ >= currentInterval) {
-        auto availableTypes = getExistingStationTypes();
-        auto graphSnap = graph_.snapshot();
+        std::span<const StationId> stations = graph_.stationIds();
+        std::array<StationType, StationType::COUNT> availableTypes;
+        const std::size_t typeCount = existingTypes(graph_.stationTypeMask(), availableTypes);
 
-        if (!graphSnap.stations.empty() && !availableTypes.empty()) {
+        if (!stations.empty() && typeCount != 0) {
 
             // 1. Pick a random origin station index
-            std::uniform_int_distribution<size_t> stationDist(0, graphSnap.stations.size() - 1);
+            std::uniform_int_distribution<size_t> stationDist(0, stations.size() - 1);
             size_t originIdx = stationDist(rng_); // Use rng_ here
-            uint32_t originId = graphSnap.stations[originIdx].id;
+            uint32_t originId = stations[originIdx];
+            StationType originType = graph_.getStation(originId)->type;
 
             // 2. Pick a random destination type index
-            std::uniform_int_distribution<size_t> typeDist(0, availableTypes.size() - 1);
+            std::uniform_int_distribution<size_t> typeDist(0, typeCount - 1);
             StationType destType;
-            if (availableTypes.size() == 1) {
+            if (typeCount == 1) {
                 destType = availableTypes[0];
-                if (destType == graphSnap.stations[originIdx].type) {
+                if (destType == originType) {
                     // If the only available type is the same as the origin station's type, skip
                     // spawning
-                    std::cout << "Only one station type available and it's the same as the origin. "
-                                 "Skipping spawn."
-                              << std::endl;
+                    METRO_LOG(DEBUG, SIMULATION,
+                              "Only one station type available and it's the same as the origin. "
+                              "Skipping spawn.");
                     spawnAccumulator_ = 0.0f; // Reset accumulator even if we skip spawning
                     return;
                 }
             } else {
                 do {
                     destType = availableTypes[typeDist(rng_)];
-                } while (destType == graphSnap.stations[originIdx].type);
+                } while (destType == originType);
             }
             this->enqueueCommand(
                 AddPassengerCmd{.stationId = originId, .destinationType = destType});
@@ -77,66 +128,210 @@ void Simulation::addRiver(const std::vector<std::pair<float, float>>& points, fl
         riverPath.points.push_back({x, y});
     }
     rivers_[riverId] = std::make_pair(riverPath, width);
+    worldHash_ ^= pathHash(StateHash::fields(StateHash::RIVER, {riverId, StateHash::bits(width)}),
+                           riverPath);
 }
 
 SimulationSnapshot Simulation::snapshot() const {
     SimulationSnapshot snap;
-    GraphSnapshot graphSnap = this->graph_.snapshot();
-    WorldSnapshot worldSnap = this->world_.snapshot();
-    snap.tick = this->tickCount_;
-    snap.stations = graphSnap.stations;
-    snap.trains = graphSnap.trains;
-    snap.passengers = graphSnap.passengers;
-    snap.lines = graphSnap.lines;
-    snap.score = graphSnap.score;
-    snap.stationPositions = worldSnap.stationPositions;
-    for (auto& train : graphSnap.trains) {
-        if (train.state == TrainState::MOVING) {
-            auto it1 = worldSnap.stationPositions.find(train.stationId);
-            auto it2 = worldSnap.stationPositions.find(train.nextStationId);
-            if (it1 != worldSnap.stationPositions.end() &&
-                it2 != worldSnap.stationPositions.end()) {
-                snap.trainPositions[train.id] = world_.getPositionOnEdge(
-                    train.stationId, train.nextStationId, train.progress, train.forward);
-            }
+    snapshot(snap);
+    return snap;
+}
+
+void Simulation::snapshot(SimulationSnapshot& out) const {
+    graph_.snapshot(out);
+    out.tick = tickCount_;
+    assignMap(out.stationPositions, world_.stationPositions);
+    assignMap(out.edgePaths, world_.edgePaths);
+
+    std::size_t placed = 0;
+    for (const TrainView& train : out.trains) {
+        if (auto pos = _trainPosition(train.stationId, train.nextStationId, train.forward,
+                                      train.state, train.progress)) {
+            out.trainPositions[train.id] = *pos;
+            ++placed;
         } else {
-            auto it = worldSnap.stationPositions.find(train.stationId);
-            if (it != worldSnap.stationPositions.end()) {
-                snap.trainPositions[train.id] = it->second;
-            }
+            out.trainPositions.erase(train.id);
         }
     }
+    // Entries of trains that are gone; the ones just written are current.
+    if (out.trainPositions.size() > placed) {
+        std::erase_if(out.trainPositions, [&](const auto& entry) {
+            return std::none_of(out.trains.begin(), out.trains.end(),
+                                [&](const TrainView& t) { return t.id == entry.first; });
+        });
+    }
 
-    for (auto& line : graphSnap.lines) {
+    std::size_t drawn = 0;
+    for (const LineView& line : out.lines) {
+        if (line.stationIds.size() < 2) {
+            out.linePaths.erase(line.id);
+            continue;
+        }
+        std::vector<Polyline>& paths = out.linePaths[line.id];
+        paths.resize(line.stationIds.size() - 1);
         for (size_t i = 0; i + 1 < line.stationIds.size(); ++i) {
             auto key = std::make_pair(std::min(line.stationIds[i], line.stationIds[i + 1]),
                                       std::max(line.stationIds[i], line.stationIds[i + 1]));
-            snap.linePaths[line.id].push_back(worldSnap.edgePaths.at(key));
+            paths[i] = world_.edgePaths.at(key);
         }
+        ++drawn;
     }
-    snap.edgePaths = worldSnap.edgePaths;
-    return snap;
+    if (out.linePaths.size() > drawn) { // paths of removed lines
+        std::erase_if(out.linePaths, [&](const auto& entry) {
+            return std::none_of(out.lines.begin(), out.lines.end(),
+                                [&](const LineView& l) { return l.id == entry.first; });
+        });
+    }
+}
+
+std::uint64_t Simulation::changeVersion() const {
+    return graph_.changeVersion();
+}
+
+void Simulation::changesSince(std::uint64_t version, SimulationDelta& out) {
+    graph_.changesSince(version, out.graph);
+    out.tick = tickCount_;
+    out.stationPositions.clear();
+    out.edgePaths.clear();
+    out.trainPositions.clear();
+
+    if (out.graph.full) {
+        out.stationPositions.assign(world_.stationPositions.begin(),
+                                    world_.stationPositions.end());
+        out.edgePaths.assign(world_.edgePaths.begin(), world_.edgePaths.end());
+    } else {
+        for (const StationView& station : out.graph.stations) {
+            if (auto it = world_.stationPositions.find(station.id);
+                it != world_.stationPositions.end()) {
+                out.stationPositions.emplace_back(*it);
+            }
+        }
+        for (const LineView& line : out.graph.lines) {
+            for (size_t i = 0; i + 1 < line.stationIds.size(); ++i) {
+                auto key = std::make_pair(std::min(line.stationIds[i], line.stationIds[i + 1]),
+                                          std::max(line.stationIds[i], line.stationIds[i + 1]));
+                if (auto it = world_.edgePaths.find(key); it != world_.edgePaths.end()) {
+                    out.edgePaths.emplace_back(*it);
+                }
+            }
+        }
+    }
+
+    for (const auto& [_, train] : out.graph.trains) {
+        if (auto pos = _trainPosition(train.stationId, train.nextStationId, train.forward,
+                                      train.state, train.progress)) {
+            out.trainPositions.emplace_back(train.id, *pos);
+        }
+    }
+    const std::vector<Train>& trains = graph_.getTrains();
+    for (auto [index, progress] : out.graph.progress) {
+        const Train& t = trains[index];
+        if (auto pos = _trainPosition(t.currentStationId, t.nextStationId, t.direction == 1,
+                                      t.state, progress)) {
+            out.trainPositions.emplace_back(t.trainId, *pos);
+        }
+    }
+}
+
+std::optional<std::pair<float, float>> Simulation::_trainPosition(StationId stationId,
+                                                                  StationId nextStationId,
+                                                                  bool forward, TrainState state,
+                                                                  float progress) const {
+    auto from = world_.stationPositions.find(stationId);
+    if (state == TrainState::MOVING) {
+        if (from != world_.stationPositions.end() &&
+            world_.stationPositions.contains(nextStationId)) {
+            return world_.getPositionOnEdge(stationId, nextStationId, progress, forward);
+        }
+    } else if (from != world_.stationPositions.end()) {
+        return from->second;
+    }
+    return std::nullopt;
 }
 
 void Simulation::enqueueCommand(SimulationCommand cmd) {
-    pending_.push_back(cmd);
+    pending_.push(std::move(cmd));
+}
+
+std::uint64_t Simulation::tickCount() const {
+    return tickCount_;
+}
+
+std::uint32_t Simulation::completedPassengers() const {
+    return graph_.completedPassengers();
+}
+
+bool Simulation::isFailed() const {
+    return graph_.isFailed();
+}
+
+void Simulation::setBoardingPolicy(BoardingPolicy p) {
+    graph_.setBoardingPolicy(p);
+}
+
+void Simulation::setAvailableBridges(int bridges) {
+    availableBridges_ = bridges;
+}
+
+void Simulation::setTickThreads(std::size_t threads) {
+    graph_.setTickPool(nullptr);
+    tickPool_.reset();
+    if (threads > 1) {
+        tickPool_ = std::make_unique<ThreadPool>(threads);
+        graph_.setTickPool(tickPool_.get());
+    }
+}
+
+void Simulation::setInvariantChecks(InvariantChecks mode, std::uint32_t sampleTicks) {
+    graph_.setInvariantChecks(mode, sampleTicks);
+}
+
+std::uint64_t Simulation::invariantChecksRun() const {
+    return graph_.invariantChecksRun();
+}
+
+void Simulation::collectQueueLengths(std::vector<std::uint32_t>& out) const {
+    graph_.collectQueueLengths(out);
+}
+
+void Simulation::collectWaitTimes(std::vector<std::uint32_t>& out) const {
+    graph_.collectWaitTimes(out);
 }
 
 std::uint64_t Simulation::stateHash() const {
-    return tickCount_ ^ seed_;
+    return graph_.stateHash() ^ worldHash_ ^
+           StateHash::fields(StateHash::SIMULATION,
+                             {tickCount_, seed_, rng_.draws(), StateHash::bits(spawnAccumulator_),
+                              static_cast<std::uint64_t>(availableBridges_)});
+}
+
+void Simulation::_updateWorldEdge(std::uint32_t a, std::uint32_t b, bool bridge,
+                                  const Polyline& path) {
+    auto key = std::make_pair(std::min(a, b), std::max(a, b));
+    const std::uint64_t edge = StateHash::fields(StateHash::WORLD_EDGE, {key.first, key.second});
+    if (auto it = world_.edgePaths.find(key); it != world_.edgePaths.end()) {
+        worldHash_ ^= pathHash(edge, it->second);
+    }
+    world_.updateEdge(a, b, bridge, path);
+    worldHash_ ^= pathHash(edge, world_.edgePaths.at(key));
 }
 
 void Simulation::_applyCommands() {
-    for (auto& cmd : pending_) {
+    SimulationCommand cmd;
+    while (pending_.tryPop(cmd)) {
         std::visit(
             [&](auto&& c) {
                 using T = std::decay_t<decltype(c)>;
 
                 if constexpr (std::is_same_v<T, AddStationCmd>) {
-                    std::cout << "Adding station at position (" << c.x << ", " << c.y
-                              << ") with type " << c.type << std::endl;
+                    METRO_LOG(INFO, COMMANDS, "Adding station at position (", c.x, ", ", c.y,
+                              ") with type ", c.type);
                     auto id = graph_.addStationAtPosition(c.x, c.y, c.type);
                     world_.setStationPosition(id, {c.x, c.y});
+                    worldHash_ ^=
+                        StateHash::fields(StateHash::STATION_POSITION,
+                                          {id, StateHash::bits(c.x), StateHash::bits(c.y)});
                 }
 
                 if constexpr (std::is_same_v<T, AddLineCmd>) {
@@ -151,8 +346,8 @@ void Simulation::_applyCommands() {
                 }
 
                 if constexpr (std::is_same_v<T, AddStationToLineCmd>) {
-                    std::cout << "Adding station " << c.stationId << " to line " << c.lineId
-                              << std::endl;
+                    METRO_LOG(INFO, COMMANDS, "Adding station ", c.stationId, " to line ",
+                              c.lineId);
                     graph_.addStationToLineAtIndex(c.lineId, c.stationId, c.index);
                     if (c.startStationId != 0) {
                         Vector2 posA = world_.getStationPosition(c.startStationId);
@@ -163,14 +358,14 @@ void Simulation::_applyCommands() {
                         for (const auto& [id, pair] : rivers_) {
                             const auto& river = pair.first;
                             const auto& width = pair.second;
-                            std::cout << "Checking if track between station " << c.startStationId
-                                      << " and " << c.stationId << " intersects a river."
-                                      << std::endl;
+                            METRO_LOG(DEBUG, COMMANDS, "Checking if track between station ",
+                                      c.startStationId, " and ", c.stationId,
+                                      " intersects a river.");
                             if (WorldGeometry::doesTrackNeedBridge(track.points, river.points)) {
                                 intersectingRiver = pair;
-                                std::cout << "Track between station " << c.startStationId << " and "
-                                          << c.stationId
-                                          << " intersects a river and needs a bridge." << std::endl;
+                                METRO_LOG(INFO, COMMANDS, "Track between station ",
+                                          c.startStationId, " and ", c.stationId,
+                                          " intersects a river and needs a bridge.");
                                 break;
                             }
                         }
@@ -181,36 +376,29 @@ void Simulation::_applyCommands() {
                                 Polyline bridgePath = WorldGeometry::createBridgedPath(
                                     posA, posB, intersectingRiver->first.points,
                                     intersectingRiver->second);
-                                world_.updateEdge(c.startStationId, c.stationId, true, bridgePath);
+                                _updateWorldEdge(c.startStationId, c.stationId, true, bridgePath);
+                                graph_.setEdgeLength(c.startStationId, c.stationId,
+                                                     bridgePath.totalLength);
 
                                 // Proceed with adding to graph...
                             } else {
                                 // REJECT: Not enough bridges!
-                                std::cout << "Cannot add line: No bridges left!" << std::endl;
+                                METRO_LOG(WARN, COMMANDS, "Cannot add line: No bridges left!");
                                 return;
                             }
                         } else {
                             Polyline path = WorldGeometry::getOctilinearPath(posA, posB);
-                            world_.updateEdge(c.startStationId, c.stationId, false, path);
+                            _updateWorldEdge(c.startStationId, c.stationId, false, path);
+                            graph_.setEdgeLength(c.startStationId, c.stationId, path.totalLength);
                         }
                     }
                 }
 
                 if constexpr (std::is_same_v<T, AddTrainToLineCmd>) {
-                    std::cout << "Adding train to line " << c.lineId << std::endl;
+                    METRO_LOG(INFO, COMMANDS, "Adding train to line ", c.lineId);
                     graph_.addTrain(c.lineId, 10, 0.1f);
                 }
             },
             cmd);
     }
-    pending_.clear();
-}
-
-std::vector<StationType> Simulation::getExistingStationTypes() const {
-    auto snap = graph_.snapshot();
-    std::set<StationType> types;
-    for (const auto& s : snap.stations) {
-        types.insert(s.type);
-    }
-    return {types.begin(), types.end()};
 }
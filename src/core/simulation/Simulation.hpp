@@ -4,9 +4,14 @@
 #include "core/simulation/SimulationSnapshot.hpp"
 #include "core/simulation/TickClock.hpp"
 #include "core/world/Polyline.hpp"
+#include "core/utils/MpscQueue.hpp"
+#include "core/utils/ThreadPool.hpp"
 #include "core/world/World.hpp"
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <optional>
 #include <random>
 #include <set>
 
@@ -14,30 +19,89 @@ class Simulation {
   public:
     explicit Simulation(std::uint64_t seed);
 
+    // Safe to call from any thread, also while a SimulationThread runs the simulation; commands
+    // are applied at the start of the next tick, each thread's in the order it sent them.
     void enqueueCommand(SimulationCommand cmd);
     void step(std::chrono::milliseconds dt);
     void addRiver(const std::vector<std::pair<float, float>>& points, float width);
 
     Polyline getOctilinearPath(Vector2 start, Vector2 end) const;
 
+    std::uint64_t tickCount() const;
+    std::uint32_t completedPassengers() const;
+    bool isFailed() const;
+
+    void setBoardingPolicy(BoardingPolicy p);
+    void setAvailableBridges(int bridges);
+    // Steps trains on this many threads; 0 or 1 keeps the whole tick on the caller's thread.
+    // The simulation is the same either way.
+    void setTickThreads(std::size_t threads);
+    void setInvariantChecks(InvariantChecks mode,
+                            std::uint32_t sampleTicks = METRO_INVARIANT_SAMPLE_TICKS);
+    std::uint64_t invariantChecksRun() const;
+    void collectQueueLengths(std::vector<std::uint32_t>& out) const;
+    void collectWaitTimes(std::vector<std::uint32_t>& out) const;
+
+    // Graph::stateHash combined with the world geometry, RNG position and spawn timer. Kept up to
+    // date as the state changes, so it is cheap enough to compare every tick.
     std::uint64_t stateHash() const;
     SimulationSnapshot snapshot() const;
+    // Overwrites `out` in place. Vectors keep their capacity and map entries are reused while
+    // the keys stay the same, so a caller that keeps one snapshot across frames does not
+    // allocate between edits.
+    void snapshot(SimulationSnapshot& out) const;
+    // Version of the latest change to stations, lines or trains, for changesSince.
+    std::uint64_t changeVersion() const;
+    // What changed after `version` (0 for everything), for readers keeping their own copy of the
+    // snapshot; see RetainedSnapshot. Geometry is only copied for stations and lines that
+    // changed, so a tick without edits costs the changed queues and the moving trains.
+    void changesSince(std::uint64_t version, SimulationDelta& out);
 
   private:
+    // std::mt19937 that counts its draws, so its state hashes as (seed, draws).
+    class CountingRng {
+      public:
+        using result_type = std::mt19937::result_type;
+
+        explicit CountingRng(std::uint64_t seed) : engine_(seed) {}
+        static constexpr result_type min() {
+            return std::mt19937::min();
+        }
+        static constexpr result_type max() {
+            return std::mt19937::max();
+        }
+        result_type operator()() {
+            ++this->draws_;
+            return this->engine_();
+        }
+        std::uint64_t draws() const {
+            return this->draws_;
+        }
+
+      private:
+        std::mt19937 engine_;
+        std::uint64_t draws_ = 0;
+    };
+
     void _applyCommands();
-    std::vector<StationType> getExistingStationTypes() const;
+    void _updateWorldEdge(std::uint32_t a, std::uint32_t b, bool bridge, const Polyline& path);
+    std::optional<std::pair<float, float>> _trainPosition(StationId stationId,
+                                                          StationId nextStationId, bool forward,
+                                                          TrainState state, float progress) const;
 
     int availableBridges_ = 3; // Starting bridges
-    std::vector<SimulationCommand> pending_;
+    MpscQueue<SimulationCommand> pending_;
     std::uint64_t tickCount_{0};
     std::uint64_t seed_;
-    std::mt19937 rng_;
+    CountingRng rng_;
     float spawnAccumulator_ = 0.0f;
     float baseSpawnInterval_ = 0.2f; // Seconds between spawns
 
     TickClock clock_{std::chrono::milliseconds(1000)};
     std::map<std::uint32_t, std::pair<Polyline, float>> rivers_; // Loaded from JSON
     std::set<std::pair<uint32_t, uint32_t>> bridgedEdges_;
+    std::unique_ptr<ThreadPool> tickPool_; // declared before graph_, which points at it
     Graph graph_;
     World world_;
+    std::uint64_t worldHash_ = 0; // station positions, rivers and edge paths
 };
@@ -1,17 +1,27 @@
+#pragma once
 #include "core/graph/SimulationSnapshot.hpp"
 #include "core/world/Polyline.hpp"
 #include <cstdint>
 #include <map>
+#include <utility>
+#include <vector>
 
-struct SimulationSnapshot {
-    uint64_t tick;
-    std::vector<StationView> stations;
-    std::vector<TrainView> trains;
-    std::vector<PassengerView> passengers;
-    std::vector<LineView> lines;
+// The graph snapshot plus the geometry to draw it: tick, stations, trains, passengers, lines and
+// score come from GraphSnapshot, with the simulation's tick count as the tick.
+struct SimulationSnapshot : GraphSnapshot {
     std::map<uint32_t, std::pair<float, float>> stationPositions;
     std::map<uint32_t, std::vector<Polyline>> linePaths;
     std::map<std::pair<uint32_t, uint32_t>, Polyline> edgePaths;
     std::map<std::uint32_t, std::pair<float, float>> trainPositions;
-    std::uint32_t score;
-};
\ No newline at end of file
+};
+
+// Simulation::changesSince: the graph's changes plus the geometry that goes with them. Positions
+// come for the stations in graph.stations, edge paths for the lines in graph.lines and train
+// positions for every train in graph.trains or graph.progress; on a full delta, for everything.
+struct SimulationDelta {
+    GraphDelta graph;
+    uint64_t tick;
+    std::vector<std::pair<uint32_t, std::pair<float, float>>> stationPositions;
+    std::vector<std::pair<std::pair<uint32_t, uint32_t>, Polyline>> edgePaths;
+    std::vector<std::pair<std::uint32_t, std::pair<float, float>>> trainPositions;
+};
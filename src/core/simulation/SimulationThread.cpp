@@ -0,0 +1,105 @@
+#include "SimulationThread.hpp"
+#include "core/simulation/Simulation.hpp"
+#include <algorithm>
+#include <utility>
+
+SimulationThread::SimulationThread(Simulation& sim, std::chrono::milliseconds frame,
+                                   std::chrono::milliseconds step)
+    : sim_(sim), frame_(frame), step_(step) {
+}
+
+SimulationThread::~SimulationThread() {
+    running_.store(false, std::memory_order_release);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void SimulationThread::start() {
+    if (thread_.joinable()) {
+        return;
+    }
+    error_ = nullptr;
+    this->_publish();
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread([this] { this->_run(); });
+}
+
+void SimulationThread::stop() {
+    running_.store(false, std::memory_order_release);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (error_) {
+        std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+}
+
+bool SimulationThread::running() const {
+    return running_.load(std::memory_order_acquire);
+}
+
+const SimulationSnapshot& SimulationThread::latest() {
+    if (middle_.load(std::memory_order_acquire) & FRESH) {
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & ~FRESH;
+    }
+    return buffers_[front_].snapshot();
+}
+
+std::uint64_t SimulationThread::published() const {
+    return published_.load(std::memory_order_acquire);
+}
+
+std::size_t SimulationThread::loggedDeltas() const {
+    return log_.size();
+}
+
+void SimulationThread::_run() {
+    auto next = std::chrono::steady_clock::now();
+    try {
+        while (running_.load(std::memory_order_acquire)) {
+            const std::uint64_t before = sim_.tickCount();
+            sim_.step(step_);
+            if (sim_.tickCount() != before) {
+                this->_publish();
+            }
+            if (frame_.count() > 0) {
+                next += frame_;
+                std::this_thread::sleep_until(next);
+            }
+        }
+    } catch (...) {
+        error_ = std::current_exception();
+        running_.store(false, std::memory_order_release);
+    }
+}
+
+void SimulationThread::_publish() {
+    SimulationDelta& delta = log_.emplace_back();
+    sim_.changesSince(version_, delta);
+    version_ = delta.graph.version;
+
+    // The back buffer was last written one or more publications ago; replay what it missed, or
+    // start it over when the log no longer reaches back that far.
+    const std::uint64_t newest = logBase_ + log_.size() - 1;
+    if (applied_[back_] + 1 < logBase_) {
+        sim_.changesSince(0, full_); // as of version_, which nothing has changed since
+        buffers_[back_].apply(full_);
+    } else {
+        for (std::uint64_t n = applied_[back_] + 1; n <= newest; ++n) {
+            buffers_[back_].apply(log_[n - logBase_]);
+        }
+    }
+    applied_[back_] = newest;
+    back_ = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel) & ~FRESH;
+    published_.fetch_add(1, std::memory_order_release);
+
+    // Keep what the furthest-behind buffer still needs, but no more than MAX_LOG_DELTAS: a reader
+    // that stops calling latest() would otherwise grow the log by one delta per publication.
+    const std::uint64_t oldest = std::max(*std::min_element(applied_.begin(), applied_.end()),
+                                          newest - std::min<std::uint64_t>(newest, MAX_LOG_DELTAS));
+    while (!log_.empty() && logBase_ <= oldest) {
+        log_.pop_front();
+        ++logBase_;
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "core/simulation/RetainedSnapshot.hpp"
+#include "core/simulation/SimulationSnapshot.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <thread>
+
+class Simulation;
+
+// Runs a Simulation on its own thread and publishes a snapshot after every tick, so rendering
+// and simulation never wait for each other. The thread calls Simulation::step(step) once every
+// `frame` of wall-clock time; a zero frame runs flat out.
+//
+// Snapshots go through a triple buffer: the simulation thread fills the back buffer and swaps it
+// with the middle one in a single atomic exchange, and latest() swaps the middle buffer to the
+// front when a newer one is there. Neither side locks, and the front buffer is never written
+// while the reader holds it. Each buffer is a RetainedSnapshot that catches up from a short log
+// of deltas, so publishing copies what changed rather than the whole state. The log keeps at most
+// MAX_LOG_DELTAS; a buffer the reader held on to for longer than that starts over from a full
+// delta the next time it is written.
+//
+// While the thread runs, the simulation may only be reached through enqueueCommand and the
+// thread-safe const helpers such as getOctilinearPath.
+class SimulationThread {
+  public:
+    explicit SimulationThread(Simulation& sim,
+                              std::chrono::milliseconds frame = std::chrono::milliseconds(16),
+                              std::chrono::milliseconds step = std::chrono::milliseconds(16));
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    // Publishes the current state, then starts stepping. No-op until stop() once started.
+    void start();
+    // Waits for the current step to finish; the simulation is the caller's again afterwards.
+    // Rethrows an exception that ended the thread early.
+    void stop();
+    bool running() const;
+
+    // The most recently published snapshot. Never blocks; the reference stays valid and
+    // unchanged until the next latest() call. One reader thread only.
+    const SimulationSnapshot& latest();
+    // Snapshots published so far.
+    std::uint64_t published() const;
+    // Deltas kept for buffers that are behind, at most MAX_LOG_DELTAS. Only meaningful while the
+    // thread is stopped.
+    std::size_t loggedDeltas() const;
+
+    static constexpr std::size_t MAX_LOG_DELTAS = 64;
+
+  private:
+    void _run();
+    void _publish();
+
+    static constexpr std::uint8_t FRESH = 4; // set in middle_ when the reader has not taken it
+
+    Simulation& sim_;
+    std::chrono::milliseconds frame_;
+    std::chrono::milliseconds step_;
+
+    std::array<RetainedSnapshot, 3> buffers_;
+    std::uint8_t back_ = 0;               // simulation thread's
+    std::atomic<std::uint8_t> middle_{1}; // buffer index, | FRESH once published
+    std::uint8_t front_ = 2;              // reader's
+    // Simulation thread only: deltas not yet applied to every buffer, and how far each got.
+    std::deque<SimulationDelta> log_;
+    std::uint64_t logBase_ = 1; // number of log_.front(), counting from 1
+    std::array<std::uint64_t, 3> applied_{};
+    SimulationDelta full_{}; // rebuilds a buffer the log was trimmed past
+    std::uint64_t version_ = 0; // simulation change version the log is up to
+
+    std::atomic<bool> running_{false};
+    std::atomic<std::uint64_t> published_{0};
+    std::exception_ptr error_; // from the simulation thread, read after join
+    std::thread thread_;
+};
@@ -0,0 +1,7 @@
+#pragma once
+#include <cstddef>
+
+// Alignment that keeps fields written by different threads on separate cache lines. A fixed 64
+// rather than std::hardware_destructive_interference_size, which GCC warns about in headers
+// because its value may change between compiler versions.
+constexpr std::size_t CACHE_LINE = 64;
@@ -1,50 +1,43 @@
 #include "core/utils/LevelLoader.hpp"
 #include <fstream>
-#include <iostream>
-
-// Initialize static members
-std::vector<LevelMetadata> LevelLoader::levelsMetadata_;
-nlohmann::json LevelLoader::cachedJson_;
-bool LevelLoader::isLoaded_ = false;
-
-// LevelLoader.cpp
-
-void LevelLoader::ensureLoaded(const std::string& path) {
-    if (isLoaded_)
-        return;
+#include <stdexcept>
 
+LevelLoader::LevelLoader(const std::string& path) {
     std::ifstream f(path);
     if (!f.is_open()) {
         throw std::runtime_error("Could not open levels file: " + path);
     }
 
     // Parse the entire file into memory once
-    cachedJson_ = nlohmann::json::parse(f);
+    json_ = nlohmann::json::parse(f);
+    this->_indexLevels();
+}
+
+LevelLoader::LevelLoader(std::istream& in) {
+    json_ = nlohmann::json::parse(in);
+    this->_indexLevels();
+}
 
-    // Populate metadata cache for the menu
-    levelsMetadata_.clear();
-    for (const auto& l : cachedJson_["levels"]) {
+// Populate metadata for the menu
+void LevelLoader::_indexLevels() {
+    for (const auto& l : json_["levels"]) {
         LevelMetadata meta;
         meta.id = l["id"];
         meta.name = l["name"];
         meta.description = l.value("description", "");
         levelsMetadata_.push_back(meta);
     }
-
-    isLoaded_ = true;
 }
 
-const std::vector<LevelMetadata>& LevelLoader::getAvailableLevels(const std::string& path) {
-    ensureLoaded(path);
+const std::vector<LevelMetadata>& LevelLoader::getAvailableLevels() const {
     return levelsMetadata_;
 }
 
-LevelConfig LevelLoader::loadLevel(int levelId, const std::string& path) {
-    ensureLoaded(path);
-
-    for (const auto& l : cachedJson_["levels"]) {
+LevelConfig LevelLoader::loadLevel(int levelId) const {
+    for (const auto& l : json_["levels"]) {
         if (l["id"] == levelId) {
             LevelConfig cfg;
+            cfg.id = levelId;
             cfg.name = l["name"];
             cfg.seed = l["seed"];
             cfg.initialInterval = l["difficulty"]["initialSpawnInterval"];
@@ -52,8 +45,12 @@ LevelConfig LevelLoader::loadLevel(int levelId, const std::string& path) {
             cfg.minInterval = l["difficulty"]["minInterval"];
             cfg.initialTrains = l["resources"]["initialTrains"];
 
+            cfg.bridges = l["resources"].value("bridges", 3);
+
             for (auto& line : l["resources"]["initialLines"]) {
-                cfg.initialLines.push_back({line["id"], line["hex"]});
+                cfg.initialLines.push_back({line["id"], line["hex"],
+                                            line.value("stations", std::vector<int>{}),
+                                            line.value("trains", 0)});
             }
 
             for (auto& st : l["resources"]["initialStations"]) {
@@ -71,5 +68,48 @@ LevelConfig LevelLoader::loadLevel(int levelId, const std::string& path) {
             return cfg;
         }
     }
-    throw std::runtime_error("Level ID not found in cache: " + std::to_string(levelId));
-}
\ No newline at end of file
+    throw std::runtime_error("Level ID not found: " + std::to_string(levelId));
+}
+
+nlohmann::json LevelLoader::toJson(const LevelConfig& cfg, const std::string& description) {
+    nlohmann::json level;
+    level["id"] = cfg.id;
+    level["name"] = cfg.name;
+    level["description"] = description;
+    level["seed"] = cfg.seed;
+    level["difficulty"] = {{"initialSpawnInterval", cfg.initialInterval},
+                           {"spawnRampRate", cfg.rampRate},
+                           {"minInterval", cfg.minInterval}};
+
+    nlohmann::json rivers = nlohmann::json::array();
+    for (const auto& [id, river] : cfg.geography) {
+        nlohmann::json points = nlohmann::json::array();
+        for (const auto& [x, y] : river.second) {
+            points.push_back({{"x", x}, {"y", y}});
+        }
+        rivers.push_back({{"id", id}, {"points", points}, {"width", river.first}});
+    }
+    level["geography"] = {{"rivers", rivers}};
+
+    nlohmann::json lines = nlohmann::json::array();
+    for (const auto& line : cfg.initialLines) {
+        nlohmann::json entry = {{"id", line.id}, {"hex", line.hex}};
+        if (!line.stations.empty()) {
+            entry["stations"] = line.stations;
+        }
+        if (line.trains > 0) {
+            entry["trains"] = line.trains;
+        }
+        lines.push_back(entry);
+    }
+    nlohmann::json stations = nlohmann::json::array();
+    for (const auto& st : cfg.initialStations) {
+        stations.push_back(
+            {{"x", st.x}, {"y", st.y}, {"type", st.type}, {"passengers", st.passengers}});
+    }
+    level["resources"] = {{"initialLines", lines},
+                          {"initialTrains", cfg.initialTrains},
+                          {"bridges", cfg.bridges},
+                          {"initialStations", stations}};
+    return level;
+}
@@ -1,5 +1,7 @@
 #pragma once
 #include <cstdint>
+#include <istream>
+#include <map>
 #include <nlohmann/json.hpp>
 #include <string>
 #include <utility>
@@ -16,6 +18,8 @@ struct StationInit {
 struct LineInit {
     int id;
     std::string hex;
+    std::vector<int> stations{}; // indices into initialStations, in line order (may be empty)
+    int trains = 0;              // trains placed on the line when it is built
 };
 
 struct LevelConfig {
@@ -26,6 +30,7 @@ struct LevelConfig {
     float rampRate;
     float minInterval;
     int initialTrains;
+    int bridges = 3;
     std::vector<LineInit> initialLines;
     std::vector<StationInit> initialStations;
     std::map<std::uint32_t, std::pair<float, std::vector<std::pair<float, float>>>> geography;
@@ -37,17 +42,22 @@ struct LevelMetadata {
     std::string description;
 };
 
+// Parses a levels file once at construction. Each loader owns its parsed copy, so independent
+// loaders (and simulations built from them) share no mutable state across threads.
 class LevelLoader {
   public:
-    static LevelConfig loadLevel(int levelId, const std::string& path = "assets/levels.json");
-    static const std::vector<LevelMetadata>&
-    getAvailableLevels(const std::string& path = "assets/levels.json");
+    explicit LevelLoader(const std::string& path = "assets/levels.json");
+    explicit LevelLoader(std::istream& in);
+
+    LevelConfig loadLevel(int levelId) const;
+    const std::vector<LevelMetadata>& getAvailableLevels() const;
+
+    // Inverse of loadLevel: one entry of the "levels" array.
+    static nlohmann::json toJson(const LevelConfig& cfg, const std::string& description = "");
 
   private:
-    static void ensureLoaded(const std::string& path);
+    void _indexLevels();
 
-    static std::vector<LevelMetadata> levels_;
-    static std::vector<LevelMetadata> levelsMetadata_;
-    static nlohmann::json cachedJson_;
-    static bool isLoaded_;
+    nlohmann::json json_;
+    std::vector<LevelMetadata> levelsMetadata_;
 };
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "core/utils/Logger.hpp"
+#include <chrono>
+
+namespace {
+
+constexpr std::size_t RING_CAPACITY = 1 << 14;
+
+const char* levelName(LogLevel level) {
+    switch (level) {
+    case LogLevel::TRACE:
+        return "TRACE";
+    case LogLevel::DEBUG:
+        return "DEBUG";
+    case LogLevel::INFO:
+        return "INFO";
+    case LogLevel::WARN:
+        return "WARN";
+    case LogLevel::ERROR:
+        return "ERROR";
+    }
+    return "?";
+}
+
+const char* categoryName(LogCategory category) {
+    switch (category) {
+    case LogCategory::ROUTING:
+        return "routing";
+    case LogCategory::BOARDING:
+        return "boarding";
+    case LogCategory::TRAIN:
+        return "train";
+    case LogCategory::COMMANDS:
+        return "commands";
+    case LogCategory::SIMULATION:
+        return "sim";
+    case LogCategory::WORLD:
+        return "world";
+    }
+    return "?";
+}
+
+} // namespace
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger() : ring_(RING_CAPACITY) {
+#ifndef METRO_LOG_SYNC
+    drainer_ = std::thread([this] { this->_drain(); });
+#endif
+}
+
+Logger::~Logger() {
+    running_.store(false, std::memory_order_release);
+    wake_.notify_one();
+    if (drainer_.joinable()) {
+        drainer_.join();
+    }
+}
+
+void Logger::submit(const LogRecord& record) {
+#ifdef METRO_LOG_SYNC
+    this->_emit(record);
+    std::fflush(stdout);
+#else
+    if (!ring_.tryPush(record)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    pushed_.fetch_add(1, std::memory_order_release);
+    wake_.notify_one();
+#endif
+}
+
+void Logger::flush() {
+    // Wait until the drain thread has written everything pushed so far.
+    const std::uint64_t target = pushed_.load(std::memory_order_acquire);
+    while (drainer_.joinable() && written_.load(std::memory_order_acquire) < target) {
+        wake_.notify_one();
+        std::this_thread::yield();
+    }
+    std::fflush(stdout);
+}
+
+std::uint64_t Logger::dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+void Logger::_drain() {
+    LogRecord record;
+    for (;;) {
+        bool any = false;
+        while (ring_.tryPop(record)) {
+            this->_emit(record);
+            written_.fetch_add(1, std::memory_order_release);
+            any = true;
+        }
+        if (!running_.load(std::memory_order_acquire)) {
+            break;
+        }
+        if (!any) {
+            std::unique_lock lock(wakeMutex_);
+            wake_.wait_for(lock, std::chrono::milliseconds(5));
+        }
+    }
+    while (ring_.tryPop(record)) {
+        this->_emit(record);
+        written_.fetch_add(1, std::memory_order_release);
+    }
+    std::fflush(stdout);
+}
+
+void Logger::_emit(const LogRecord& record) {
+    std::fprintf(stdout, "[%s][%s] %.*s\n", levelName(record.level), categoryName(record.category),
+                 static_cast<int>(record.length), record.text.data());
+}
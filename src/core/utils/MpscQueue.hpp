@@ -0,0 +1,51 @@
+#pragma once
+#include "core/utils/CacheLine.hpp"
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Unbounded lock-free multi-producer/single-consumer queue (Vyukov). push() is one allocation
+// and one atomic exchange, so producers never wait on each other or on the consumer; values from
+// one producer come out in the order it pushed them. A push that is still linking its node can
+// hide the ones behind it from tryPop for a moment, which then reports empty. Only one thread
+// may pop at a time.
+template <typename T> class MpscQueue {
+  public:
+    MpscQueue() : head_(new Node), tail_(head_.load(std::memory_order_relaxed)) {}
+    ~MpscQueue() {
+        while (this->tail_ != nullptr) {
+            Node* next = this->tail_->next.load(std::memory_order_relaxed);
+            delete this->tail_;
+            this->tail_ = next;
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T value) {
+        Node* node = new Node{{nullptr}, std::move(value)};
+        Node* prev = this->head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    bool tryPop(T& out) {
+        Node* next = this->tail_->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return false;
+        }
+        out = std::move(next->value);
+        delete this->tail_;
+        this->tail_ = next; // the popped node is the new stub
+        return true;
+    }
+
+  private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value{};
+    };
+
+    alignas(CACHE_LINE) std::atomic<Node*> head_; // last pushed, written by producers
+    alignas(CACHE_LINE) Node* tail_;              // stub before the next value, consumer only
+};
@@ -0,0 +1,70 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+// Building blocks of the incremental state hashes kept by Graph and Simulation. Each member of
+// the state (a station, a train, a passenger, ...) hashes to one word and the state hash is the
+// XOR of those words, so a mutation costs one XOR of the member's old hash and one of its new.
+class StateHash {
+  public:
+    static constexpr std::size_t MAX_FIELDS = 16;
+
+    // Keeps members of different kinds with equal fields from cancelling each other out.
+    enum Kind : std::uint64_t {
+        STATION = 1,
+        LINE,
+        EDGE,
+        TRAIN,
+        PASSENGER,
+        GRAPH,
+        STATION_POSITION,
+        WORLD_EDGE,
+        RIVER,
+        SIMULATION,
+    };
+
+    // splitmix64 finaliser.
+    static std::uint64_t mix(std::uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    // Order-sensitive hash of one member's fields, at most MAX_FIELDS of them. Each position has
+    // its own multiplier and the products are independent, so the cost is close to one mix()
+    // however many fields there are.
+    static std::uint64_t fields(Kind kind, std::initializer_list<std::uint64_t> values) {
+        assert(values.size() <= MAX_FIELDS);
+        std::uint64_t h = kind;
+        const std::uint64_t* k = MULTIPLIERS.data();
+        for (std::uint64_t v : values) {
+            h += (v + 1) * *k++;
+        }
+        return mix(h);
+    }
+
+    static std::uint64_t bits(float f) {
+        return std::bit_cast<std::uint32_t>(f);
+    }
+
+  private:
+    // Odd splitmix64 outputs. mix() is spelled out again because the class is still incomplete.
+    static constexpr std::array<std::uint64_t, MAX_FIELDS> MULTIPLIERS = [] {
+        std::array<std::uint64_t, MAX_FIELDS> m{};
+        std::uint64_t x = 0;
+        for (std::uint64_t& k : m) {
+            x += 0x9e3779b97f4a7c15ULL;
+            std::uint64_t z = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            k = (z ^ (z >> 31)) | 1;
+        }
+        return m;
+    }();
+};
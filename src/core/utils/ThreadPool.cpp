@@ -0,0 +1,170 @@
+#include "core/utils/ThreadPool.hpp"
+#include <algorithm>
+#include <utility>
+
+ThreadPool::ThreadPool(std::size_t threads) {
+    threads = std::max<std::size_t>(1, threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        this->queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (std::size_t i = 0; i < threads; ++i) {
+        this->threads_.emplace_back([this, i] { this->_workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(this->stateMutex_);
+        this->stopping_ = true;
+    }
+    this->workAvailable_.notify_all();
+    for (auto& t : this->threads_) {
+        t.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard lock(this->stateMutex_);
+        ++this->queued_;
+        ++this->pending_;
+    }
+    auto& queue = *this->queues_[this->nextQueue_.fetch_add(1) % this->queues_.size()];
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    this->workAvailable_.notify_one();
+    this->progress_.notify_all();
+}
+
+void ThreadPool::wait() {
+    for (;;) {
+        if (this->_tryRunOne(0)) {
+            continue;
+        }
+        std::unique_lock lock(this->stateMutex_);
+        this->progress_.wait(lock, [this] { return this->pending_ == 0 || this->queued_ > 0; });
+        if (this->pending_ == 0) {
+            break;
+        }
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard lock(this->stateMutex_);
+        std::swap(error, this->error_);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& fn) {
+    if (count == 0) {
+        return;
+    }
+
+    struct Batch {
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+    };
+    auto batch = std::make_shared<Batch>();
+
+    // Helpers that start after every index is claimed return without touching fn.
+    auto drain = [batch, count, &fn] {
+        for (std::size_t i = batch->next.fetch_add(1); i < count; i = batch->next.fetch_add(1)) {
+            try {
+                fn(i);
+            } catch (...) {
+                std::lock_guard lock(batch->mutex);
+                if (!batch->error) {
+                    batch->error = std::current_exception();
+                }
+            }
+            if (batch->done.fetch_add(1) + 1 == count) {
+                std::lock_guard lock(batch->mutex);
+                batch->finished.notify_all();
+            }
+        }
+    };
+
+    std::size_t helpers = std::min(count, this->threadCount()) - 1;
+    for (std::size_t i = 0; i < helpers; ++i) {
+        this->submit(drain);
+    }
+    drain();
+
+    std::unique_lock lock(batch->mutex);
+    batch->finished.wait(lock, [&] { return batch->done.load() == count; });
+    if (batch->error) {
+        std::rethrow_exception(batch->error);
+    }
+}
+
+std::size_t ThreadPool::threadCount() const {
+    return this->threads_.size();
+}
+
+void ThreadPool::_workerLoop(std::size_t index) {
+    for (;;) {
+        if (this->_tryRunOne(index)) {
+            continue;
+        }
+        std::unique_lock lock(this->stateMutex_);
+        this->workAvailable_.wait(lock,
+                                  [this] { return this->stopping_ || this->queued_ > 0; });
+        if (this->stopping_ && this->queued_ == 0) {
+            return;
+        }
+    }
+}
+
+// Pops the newest task of the home queue, or steals the oldest task of the next non-empty one.
+bool ThreadPool::_tryRunOne(std::size_t home) {
+    std::function<void()> task;
+    for (std::size_t i = 0; i < this->queues_.size() && !task; ++i) {
+        auto& queue = *this->queues_[(home + i) % this->queues_.size()];
+        std::lock_guard lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (i == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+    if (!task) {
+        return false;
+    }
+
+    {
+        std::lock_guard lock(this->stateMutex_);
+        --this->queued_;
+    }
+    std::exception_ptr error;
+    try {
+        task();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    this->_finishTask(error);
+    return true;
+}
+
+void ThreadPool::_finishTask(std::exception_ptr error) {
+    std::lock_guard lock(this->stateMutex_);
+    --this->pending_;
+    if (error && !this->error_) {
+        this->error_ = error;
+    }
+    if (this->pending_ == 0) {
+        this->progress_.notify_all();
+    }
+}
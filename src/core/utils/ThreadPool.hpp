@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of workers, each with its own task deque. A worker runs its newest task first and,
+// when its deque is empty, steals the oldest task of another worker, so uneven tasks still
+// spread over every thread. wait() lets the caller help and rethrows the first task exception.
+class ThreadPool {
+  public:
+    explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+    void wait();
+
+    // Runs fn(0..count-1) across the pool and the calling thread. Only waits for its own
+    // indices, so it can be used while unrelated tasks are queued.
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& fn);
+
+    std::size_t threadCount() const;
+
+  private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void _workerLoop(std::size_t index);
+    bool _tryRunOne(std::size_t home);
+    void _finishTask(std::exception_ptr error);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<std::size_t> nextQueue_{0};
+
+    std::mutex stateMutex_;
+    std::condition_variable workAvailable_;
+    std::condition_variable progress_;
+    std::size_t queued_ = 0;  // pushed but not yet taken by a thread
+    std::size_t pending_ = 0; // pushed but not yet finished
+    bool stopping_ = false;
+    std::exception_ptr error_;
+};
@@ -11,4 +11,19 @@ StationType stringToType(const std::string& s) {
     if (s == "STAR")
         return StationType::STAR;
     throw std::runtime_error("Unknown station type: " + s);
+}
+
+std::string typeToString(StationType type) {
+    switch (type) {
+    case StationType::CIRCLE:
+        return "CIRCLE";
+    case StationType::SQUARE:
+        return "SQUARE";
+    case StationType::TRIANGLE:
+        return "TRIANGLE";
+    case StationType::STAR:
+        return "STAR";
+    default:
+        throw std::runtime_error("Unknown station type: " + std::to_string(type));
+    }
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "core/graph/StationType.hpp"
 #include <string>
 
-StationType stringToType(const std::string& s);
\ No newline at end of file
+StationType stringToType(const std::string& s);
+std::string typeToString(StationType type);
\ No newline at end of file
@@ -1,6 +1,6 @@
 #include "core/world/World.hpp"
+#include "core/utils/Logger.hpp"
 #include "core/world/WorldGeometry.hpp"
-#include <iostream>
 #include <stdexcept>
 
 void World::updateEdge(uint32_t idA, uint32_t idB, bool needsBridge, Polyline path) {
@@ -12,7 +12,7 @@ void World::updateEdge(uint32_t idA, uint32_t idB, bool needsBridge, Polyline pa
         edgePaths[key].bridge = false;
         edgePaths[key] = path;
     }
-    std::cout << "Updated edge between stations " << idA << " and " << idB << std::endl;
+    METRO_LOG(DEBUG, WORLD, "Updated edge between stations ", idA, " and ", idB);
 }
 
 std::pair<float, float> World::getPositionOnEdge(uint32_t idA, uint32_t idB, float progress,
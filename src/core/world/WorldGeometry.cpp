@@ -1,5 +1,5 @@
 #include "core/world/WorldGeometry.hpp"
-#include <iostream>
+#include <cmath>
 
 Polyline WorldGeometry::getOctilinearPath(Vector2 start, Vector2 end) {
     Polyline path;
@@ -2,4 +2,6 @@
 
 int const WINDOW_WIDTH = 1280;
 int const WINDOW_HEIGHT = 720;
-
+// Run the simulation on its own thread and draw its latest published snapshot, instead of
+// stepping it inside the frame. Off until the threaded path has had more play-testing.
+bool const SIMULATION_THREAD = false;
@@ -1,10 +1,10 @@
 #include "ui/screens/InGame.hpp"
 #include "core/graph/StationType.hpp"
 #include "core/graph/id.hpp"
+#include "core/simulation/LevelSetup.hpp"
 #include "core/simulation/Simulation.hpp"
 #include "core/simulation/SimulationCommand.hpp"
 #include "core/utils/LevelLoader.hpp"
-#include "core/utils/utils.hpp"
 #include "core/world/Polyline.hpp"
 #include "raylib.h"
 #include "ui/constants.hpp"
@@ -13,45 +13,49 @@
 #include <utility>
 
 Simulation InGame::InitSimulation(int levelId) {
-    auto cfg = LevelLoader::loadLevel(levelId);
+    auto cfg = LevelLoader().loadLevel(levelId);
     // Return the constructed simulation object
     return Simulation(cfg.seed);
 }
 
 InGame::InGame(int levelId)
-    : sim_(InitSimulation(levelId)) // Explicitly initialize here!
-{
+    : sim_(InitSimulation(levelId)), // Explicitly initialize here!
+      simThread_(sim_) {
     std::cout << "Initializing InGame screen with level ID: " << levelId << std::endl;
     // Now you can do the rest (adding stations, lines, etc.)
-    auto cfg = LevelLoader::loadLevel(levelId);
+    auto cfg = LevelLoader().loadLevel(levelId);
     std::cout << "Loaded level: " << cfg.name << " with seed: " << cfg.seed << std::endl;
+    applyLevel(sim_, cfg);
     for (const auto& [id, pair] : cfg.geography) {
-        sim_.addRiver(pair.second, pair.first);
         geography[id] = pair.second;
     }
-    std::cout << "Added " << cfg.geography.size() << " rivers to the simulation." << std::endl;
-    for (const auto& st : cfg.initialStations) {
-        sim_.enqueueCommand(AddStationCmd{st.x, st.y, stringToType(st.type)});
-    }
-    std::cout << "Enqueued " << cfg.initialStations.size() << " stations." << std::endl;
-    for (const auto& line : cfg.initialLines) {
-        sim_.enqueueCommand(AddLineCmd{});
-    }
-    std::cout << "Enqueued " << cfg.initialLines.size() << " lines." << std::endl;
+    std::cout << "Added " << cfg.geography.size() << " rivers, enqueued "
+              << cfg.initialStations.size() << " stations and " << cfg.initialLines.size()
+              << " lines." << std::endl;
     availableTrains_ = cfg.initialTrains;
-    paused_ = false;
+    paused_ = true; // until the first update starts the simulation
 }
 
 ScreenResult InGame::update() {
     if (IsKeyPressed(KEY_P)) {
+        simThread_.stop();
+        paused_ = true;
         return {AppState::PAUSED};
     }
 
-    if (!paused_) {
+    // First frame after entering the game or resuming from the pause menu.
+    if (paused_) {
+        paused_ = false;
+        if (SIMULATION_THREAD) {
+            simThread_.start();
+        }
+    }
+    if (!SIMULATION_THREAD) {
         sim_.step(std::chrono::milliseconds(16));
     }
 
-    auto snapshot = sim_.snapshot();
+    const SimulationSnapshot& snapshot =
+        SIMULATION_THREAD ? simThread_.latest() : view_.update(sim_);
     Vector2 mouse = GetMousePosition();
 
     if (!isDragging_ && IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -140,7 +144,8 @@ void InGame::_renderPassenger(const PassengerView& snap, Vector2 pos) {
     DrawCircleV(pos, size, color);
 }
 
-void InGame::_renderStation(const StationView& snap, Vector2 pos) {
+void InGame::_renderStation(const StationView& snap, std::span<const PassengerView> passengers,
+                            Vector2 pos) {
     float size = 15.0f;
     Color color =
         (CheckCollisionPointCircle(GetMousePosition(), pos, size + 5)) ? SKYBLUE : DARKGRAY;
@@ -162,7 +167,7 @@ void InGame::_renderStation(const StationView& snap, Vector2 pos) {
 
     float offset = 20.0f;
     for (size_t i = 0; i < snap.waiting; ++i) {
-        _renderPassenger(snap.passengers[i],
+        _renderPassenger(passengers[i],
                          (Vector2){pos.x + offset + (i % 5) * 8, pos.y - 10 + (i / 5) * 8});
     }
 }
@@ -211,7 +216,7 @@ void InGame::DrawSnapshot(const SimulationSnapshot& snap) {
                  16, BLACK);
 
         std::pair<float, float> pos = snap.stationPositions.at(s.id);
-        _renderStation(s, (Vector2){pos.first, pos.second});
+        _renderStation(s, snap.passengersOf(s.passengers), (Vector2){pos.first, pos.second});
         y += 20;
     }
     DrawText("Trains:", 20, y, 18, DARKGREEN);
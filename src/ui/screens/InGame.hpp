@@ -1,11 +1,16 @@
+#include "core/simulation/RetainedSnapshot.hpp"
 #include "core/simulation/Simulation.hpp"
+#include "core/simulation/SimulationThread.hpp"
 #include "raylib.h"
 #include "ui/Screen.hpp"
+#include <span>
 
 class InGame : public Screen {
   private:
     int level_;
     Simulation sim_;
+    RetainedSnapshot view_;      // brought up to date from sim_ every frame
+    SimulationThread simThread_; // steps sim_ instead when SIMULATION_THREAD is set
     bool paused_;
     bool isDragging_ = false;
     int selectedLine_ = -1;
@@ -19,7 +24,8 @@ class InGame : public Screen {
     std::map<std::uint32_t, std::vector<std::pair<float, float>>> geography;
 
     void _renderPassenger(const PassengerView& snap, Vector2 pos);
-    void _renderStation(const StationView& snap, Vector2 pos);
+    void _renderStation(const StationView& snap, std::span<const PassengerView> passengers,
+                        Vector2 pos);
     void DrawSnapshot(const SimulationSnapshot& snap);
 
   public:
@@ -3,8 +3,8 @@
 #include "ui/widgets/Button.hpp"
 #include <raylib.h>
 
-LevelSelect::LevelSelect() {
-    levelMeta_ = LevelLoader::getAvailableLevels();
+LevelSelect::LevelSelect() : loader_() {
+    levelMeta_ = loader_.getAvailableLevels();
     scrollOffset_ = 0.0f;
     animationStates_.clear();
     int max_rows = (levelMeta_.size()) / 3 + ((levelMeta_.size() % 3 == 0) ? 0 : 1);
@@ -94,7 +94,7 @@ void LevelSelect::drawLevelCard(const LevelMetadata& meta, Rectangle bounds, flo
     DrawRectangleRec(mapArea, Fade(BLACK, alpha * 0.05f));
 
     // Load full config just for the preview
-    auto fullCfg = LevelLoader::loadLevel(meta.id);
+    auto fullCfg = loader_.loadLevel(meta.id);
     DrawMiniMap(fullCfg, mapArea);
 
     // Text Content
@@ -12,6 +12,7 @@ class LevelSelect : public Screen {
     float scrollOffset_ = 0.0f;
     float maxScrollOffset_ = 0.0f;
     std::map<int, CardState> animationStates_;
+    LevelLoader loader_;
     std::vector<LevelMetadata> levelMeta_;
     int level_;
 
@@ -0,0 +1,28 @@
+#include "app/cli_args.hpp"
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <iostream>
+
+namespace {
+
+void printUsage() {
+    std::cerr << "usage\n";
+}
+
+} // namespace
+
+TEST(ParseNumber, ReadsWholeValues) {
+    EXPECT_EQ(parseNumber<int>("-12", printUsage), -12);
+    EXPECT_EQ(parseNumber<std::uint64_t>("18446744073709551615", printUsage), UINT64_MAX);
+    EXPECT_FLOAT_EQ(parseNumber<float>("0.25", printUsage), 0.25f);
+}
+
+TEST(ParseNumberDeathTest, PrintsUsageAndExitsOnBadValues) {
+    EXPECT_EXIT(parseNumber<std::uint64_t>("abc", printUsage), testing::ExitedWithCode(2),
+                "usage");
+    EXPECT_EXIT(parseNumber<int>("12abc", printUsage), testing::ExitedWithCode(2), "usage");
+    EXPECT_EXIT(parseNumber<int>("", printUsage), testing::ExitedWithCode(2), "usage");
+    EXPECT_EXIT(parseNumber<std::uint32_t>("-1", printUsage), testing::ExitedWithCode(2), "usage");
+    EXPECT_EXIT(parseNumber<std::uint64_t>("99999999999999999999999", printUsage),
+                testing::ExitedWithCode(2), "usage");
+}
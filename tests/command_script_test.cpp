@@ -0,0 +1,60 @@
+#include "core/simulation/CommandScript.hpp"
+#include "core/simulation/ScriptedRun.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+
+TEST(CommandScript, ParsesCommandsAndSortsByTick) {
+    std::istringstream in("# network\n"
+                          "@5 train 1\n"
+                          "station 10 20 SQUARE\n"
+                          "line   # first line\n"
+                          "@2 connect 1 2 1\n"
+                          "connect 1 3 0 0\n"
+                          "@5 passenger 2 CIRCLE\n");
+
+    auto cmds = CommandScript::parse(in);
+    ASSERT_EQ(cmds.size(), 6u);
+
+    EXPECT_EQ(cmds[0].tick, 0u);
+    const auto& st = std::get<AddStationCmd>(cmds[0].command);
+    EXPECT_FLOAT_EQ(st.x, 10.0f);
+    EXPECT_EQ(st.type, StationType::SQUARE);
+    EXPECT_TRUE(std::holds_alternative<AddLineCmd>(cmds[1].command));
+    EXPECT_EQ(std::get<AddStationToLineCmd>(cmds[2].command).index, 0u);
+
+    EXPECT_EQ(cmds[3].tick, 2u);
+    const auto& connect = std::get<AddStationToLineCmd>(cmds[3].command);
+    EXPECT_EQ(connect.stationId, 2u);
+    EXPECT_EQ(connect.startStationId, 1u);
+    EXPECT_EQ(connect.index, SIZE_MAX);
+
+    EXPECT_EQ(cmds[4].tick, 5u);
+    EXPECT_TRUE(std::holds_alternative<AddTrainToLineCmd>(cmds[4].command));
+    EXPECT_EQ(std::get<AddPassengerCmd>(cmds[5].command).destinationType, StationType::CIRCLE);
+}
+
+TEST(CommandScript, RejectsMalformedLines) {
+    std::istringstream unknown("teleport 1 2\n");
+    EXPECT_THROW(CommandScript::parse(unknown), std::runtime_error);
+
+    std::istringstream missing("station 10\n");
+    EXPECT_THROW(CommandScript::parse(missing), std::runtime_error);
+
+    std::istringstream badTick("@soon line\n");
+    EXPECT_THROW(CommandScript::parse(badTick), std::runtime_error);
+}
+
+TEST(ScriptedRun, RejectsFramesThatNeverAdvanceTime) {
+    Simulation sim(1);
+    for (auto frame : {std::chrono::milliseconds(0), std::chrono::milliseconds(-16)}) {
+        RunLimits limits{.ticks = 5, .frame = frame};
+        EXPECT_THROW(runScripted(sim, {}, limits), std::logic_error);
+    }
+    EXPECT_EQ(sim.tickCount(), 0u);
+
+    RunOutcome outcome =
+        runScripted(sim, {}, RunLimits{.ticks = 5, .frame = std::chrono::milliseconds(16)});
+    EXPECT_EQ(outcome.ticks, 5u);
+}
@@ -1,4 +1,6 @@
 #include <gtest/gtest.h>
+#include "../src/core/simulation/LevelSetup.hpp"
+#include "../src/core/simulation/NetworkGenerator.hpp"
 #include "../src/core/simulation/Simulation.hpp"
 
 TEST(Simulation, DeterministicState) {
@@ -12,3 +14,66 @@ TEST(Simulation, DeterministicState) {
 
     EXPECT_EQ(a.stateHash(), b.stateHash());
 }
+
+TEST(Simulation, StateHashFollowsTheWholeRun) {
+    NetworkGenParams params;
+    params.seed = 11;
+    params.stations = 120;
+    params.lines = 8;
+    params.maxLineLength = 12;
+    LevelConfig cfg = NetworkGenerator::generate(params);
+
+    Simulation serial(cfg.seed);
+    Simulation threaded(cfg.seed);
+    Simulation reseeded(cfg.seed + 1);
+    applyLevel(serial, cfg);
+    applyLevel(threaded, cfg);
+    applyLevel(reseeded, cfg);
+    threaded.setTickThreads(4);
+
+    bool diverged = false;
+    for (int i = 0; i < 400; ++i) {
+        std::uint64_t before = serial.stateHash();
+        serial.step(std::chrono::milliseconds(1000));
+        threaded.step(std::chrono::milliseconds(1000));
+        reseeded.step(std::chrono::milliseconds(1000));
+        ASSERT_NE(before, serial.stateHash()) << "tick " << i;
+        ASSERT_EQ(serial.stateHash(), threaded.stateHash()) << "tick " << i;
+        diverged = diverged || serial.stateHash() != reseeded.stateHash();
+    }
+    EXPECT_TRUE(diverged);
+}
+
+TEST(Graph, StateHashTracksEdits) {
+    Graph g;
+    const std::uint64_t empty = g.stateHash();
+    auto a = g.addStation(StationType::CIRCLE);
+    auto b = g.addStation(StationType::SQUARE);
+    auto c = g.addStation(StationType::TRIANGLE);
+    auto line = g.addLine();
+    g.addStationToLine(line, a);
+    g.addStationToLine(line, b);
+    g.addStationToLineAtIndex(line, c, 1);
+    g.setEdgeLength(a, c, 3.0f);
+    g.setEdgeLength(a, c, 4.0f);
+    g.addTrain(line, 4);
+    g.spawnPassengerAt(a, StationType::SQUARE);
+    g.spawnPassengerAt(c, StationType::CIRCLE);
+    EXPECT_EQ(g.stateHash(), g.computeStateHash());
+
+    for (int i = 0; i < 12; ++i) {
+        g.tick();
+        ASSERT_EQ(g.stateHash(), g.computeStateHash()) << "tick " << i;
+    }
+
+    const std::uint64_t beforeSpawn = g.stateHash();
+    g.spawnPassengerAt(c, StationType::SQUARE);
+    EXPECT_NE(g.stateHash(), beforeSpawn);
+
+    g.removeStation(c);
+    EXPECT_EQ(g.stateHash(), g.computeStateHash());
+    auto lone = g.addLine();
+    g.removeLine(lone);
+    EXPECT_EQ(g.stateHash(), g.computeStateHash());
+    EXPECT_NE(g.stateHash(), empty);
+}
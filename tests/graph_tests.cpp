@@ -80,3 +80,94 @@ TEST(GraphInvariant, DoubleRemovalThrows) {
         std::logic_error
     );
 }
+
+TEST(GraphAdjacency, IndexTracksLineEdits) {
+    Graph g;
+
+    auto s1 = g.addStation(StationType::CIRCLE);
+    auto s2 = g.addStation(StationType::SQUARE);
+    auto s3 = g.addStation(StationType::TRIANGLE);
+
+    auto l1 = g.addLine();
+    auto l2 = g.addLine();
+    g.addStationToLine(l1, s1);
+    g.addStationToLine(l1, s2);
+    g.addStationToLine(l2, s2);
+    g.addStationToLine(l2, s3);
+
+    auto n = g.adjacency().neighbours(s2);
+    auto lines = g.adjacency().edgeLines(s2);
+    ASSERT_EQ(n.size(), 2u);
+    EXPECT_EQ(n[0], s1);
+    EXPECT_EQ(lines[0], l1);
+    EXPECT_EQ(n[1], s3);
+    EXPECT_EQ(lines[1], l2);
+    EXPECT_EQ(g.adjacency().edgeCount(), 2u);
+
+    g.removeLine(l2);
+    EXPECT_EQ(g.adjacency().neighbours(s2).size(), 1u);
+    EXPECT_TRUE(g.adjacency().neighbours(s3).empty());
+
+    g.removeStation(s1);
+    EXPECT_TRUE(g.adjacency().neighbours(s2).empty());
+
+    auto s4 = g.addStation(StationType::STAR);
+    EXPECT_TRUE(g.adjacency().neighbours(s4).empty());
+}
+
+TEST(Graph, RemovedSlotIsReusedWithNewGeneration) {
+    Graph g;
+    auto a = g.addStation(StationType::CIRCLE);
+    auto b = g.addStation(StationType::SQUARE);
+    EXPECT_EQ(a, 1u);
+    EXPECT_EQ(b, 2u);
+
+    g.removeStation(a);
+    auto c = g.addStation(StationType::TRIANGLE);
+    EXPECT_NE(c, a);
+    EXPECT_EQ(slotIndex(c), slotIndex(a));
+    EXPECT_FALSE(g.stationExists(a));
+    EXPECT_EQ(g.getStation(a), nullptr);
+    EXPECT_THROW(g.removeStation(a), std::logic_error);
+    ASSERT_NE(g.getStation(c), nullptr);
+    EXPECT_EQ(g.getStation(c)->type, StationType::TRIANGLE);
+
+    // Routing and snapshots resolve the reused slot under its new id.
+    auto line = g.addLine();
+    g.addStationToLine(line, b);
+    g.addStationToLine(line, c);
+    EXPECT_EQ(g.nextHop(b, StationType::TRIANGLE), c);
+    EXPECT_EQ(g.nextHop(c, StationType::SQUARE), b);
+    EXPECT_EQ(g.computeRoute(b, StationType::TRIANGLE).path, (std::vector<StationId>{b, c}));
+
+    auto snap = g.snapshot();
+    ASSERT_EQ(snap.stations.size(), 2u);
+    EXPECT_EQ(snap.stations[0].id, c); // slot order
+    EXPECT_EQ(snap.stations[1].id, b);
+}
+
+TEST(Graph, StationIdsAndTypeMaskFollowEdits) {
+    Graph g;
+    auto a = g.addStation(StationType::CIRCLE);
+    auto b = g.addStation(StationType::SQUARE);
+    auto c = g.addStation(StationType::CIRCLE);
+    EXPECT_EQ(std::vector<StationId>(g.stationIds().begin(), g.stationIds().end()),
+              (std::vector<StationId>{a, b, c}));
+    EXPECT_EQ(g.stationTypeMask(), (1u << StationType::CIRCLE) | (1u << StationType::SQUARE));
+
+    g.removeStation(b);
+    EXPECT_EQ(std::vector<StationId>(g.stationIds().begin(), g.stationIds().end()),
+              (std::vector<StationId>{a, c}));
+    EXPECT_EQ(g.stationTypeMask(), 1u << StationType::CIRCLE);
+
+    g.removeStation(a);
+    auto d = g.addStation(StationType::STAR);
+    EXPECT_EQ(std::vector<StationId>(g.stationIds().begin(), g.stationIds().end()),
+              (std::vector<StationId>{c, d}));
+    EXPECT_EQ(g.stationTypeMask(), (1u << StationType::CIRCLE) | (1u << StationType::STAR));
+
+    g.removeStation(c);
+    g.removeStation(d);
+    EXPECT_TRUE(g.stationIds().empty());
+    EXPECT_EQ(g.stationTypeMask(), 0u);
+}
@@ -0,0 +1,156 @@
+#include "core/utils/BoundedQueue.hpp"
+#include "core/utils/Logger.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+TEST(BoundedQueue, CapacityMustBeAPowerOfTwo) {
+    for (std::size_t capacity : {0u, 1u, 3u, 6u, 100u}) {
+        EXPECT_THROW(BoundedQueue<int>{capacity}, std::logic_error) << capacity;
+    }
+    EXPECT_EQ(BoundedQueue<int>(2).capacity(), 2u);
+    EXPECT_EQ(BoundedQueue<int>(64).capacity(), 64u);
+}
+
+TEST(BoundedQueue, ReportsFullAndEmpty) {
+    BoundedQueue<int> queue(4);
+    int value = -1;
+    EXPECT_FALSE(queue.tryPop(value));
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.tryPush(i));
+    }
+    EXPECT_FALSE(queue.tryPush(4));
+
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.tryPop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.tryPop(value));
+    EXPECT_TRUE(queue.tryPush(5)); // the freed cells are usable again
+}
+
+TEST(BoundedQueue, WrapsAroundForManyLaps) {
+    BoundedQueue<int> queue(8);
+    int next = 0;
+    int expected = 0;
+    int value = -1;
+    // Five in, five out never lines up with the ring size, so every cell gets reused at a
+    // different offset on each lap.
+    for (int round = 0; round < 40; ++round) {
+        for (int i = 0; i < 5; ++i) {
+            ASSERT_TRUE(queue.tryPush(next++));
+        }
+        for (int i = 0; i < 5; ++i) {
+            ASSERT_TRUE(queue.tryPop(value));
+            ASSERT_EQ(value, expected++);
+        }
+    }
+    EXPECT_FALSE(queue.tryPop(value));
+}
+
+TEST(BoundedQueue, KeepsEachProducersOrderWithoutLoss) {
+    constexpr int PRODUCERS = 4;
+    constexpr int PER_PRODUCER = 20000;
+    BoundedQueue<std::pair<int, int>> queue(256);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&queue, p] {
+            for (int i = 0; i < PER_PRODUCER; ++i) {
+                while (!queue.tryPush({p, i})) {
+                    std::this_thread::yield(); // full: the consumer is behind
+                }
+            }
+        });
+    }
+
+    std::vector<int> next(PRODUCERS, 0);
+    int popped = 0;
+    std::pair<int, int> value;
+    while (popped < PRODUCERS * PER_PRODUCER) {
+        if (!queue.tryPop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(value.second, next[value.first]) << "producer " << value.first;
+        ++next[value.first];
+        ++popped;
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    EXPECT_EQ(next, std::vector<int>(PRODUCERS, PER_PRODUCER));
+    EXPECT_FALSE(queue.tryPop(value));
+}
+
+TEST(BoundedQueue, SeveralConsumersTakeEachValueOnce) {
+    constexpr int CONSUMERS = 3;
+    constexpr int VALUES = 60000;
+    BoundedQueue<int> queue(128);
+    std::vector<std::atomic<int>> seen(VALUES);
+    std::atomic<int> taken{0};
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < CONSUMERS; ++c) {
+        consumers.emplace_back([&] {
+            int value;
+            while (taken.load(std::memory_order_relaxed) < VALUES) {
+                if (queue.tryPop(value)) {
+                    seen[value].fetch_add(1, std::memory_order_relaxed);
+                    taken.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int i = 0; i < VALUES; ++i) {
+        while (!queue.tryPush(i)) {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& t : consumers) {
+        t.join();
+    }
+    for (int i = 0; i < VALUES; ++i) {
+        ASSERT_EQ(seen[i].load(), 1) << "value " << i;
+    }
+}
+
+#ifndef METRO_LOG_SYNC
+TEST(Logger, FlushWaitsForPushedRecordsAndCountsDrops) {
+    Logger& logger = Logger::instance();
+    logger.flush(); // nothing from earlier tests may land in the capture
+    const std::uint64_t droppedBefore = logger.dropped();
+
+    // Far more than the ring holds, pushed faster than the drain thread can write them, so some
+    // are likely dropped; each record is either written or counted.
+    constexpr int RECORDS = 100000;
+    testing::internal::CaptureStdout();
+    for (int i = 0; i < RECORDS; ++i) {
+        logger.write(LogLevel::INFO, LogCategory::COMMANDS, "logger-test ", i);
+    }
+    logger.flush();
+    const std::string out = testing::internal::GetCapturedStdout();
+
+    std::istringstream lines(out);
+    std::string line;
+    int written = 0;
+    int last = -1;
+    while (std::getline(lines, line)) {
+        if (line.rfind("[INFO][commands] logger-test ", 0) != 0) {
+            continue;
+        }
+        const int i = std::stoi(line.substr(line.rfind(' ') + 1));
+        EXPECT_GT(i, last) << "records written out of order";
+        last = i;
+        ++written;
+    }
+    const std::uint64_t dropped = logger.dropped() - droppedBefore;
+    EXPECT_GT(written, 0);
+    EXPECT_EQ(static_cast<std::uint64_t>(written) + dropped, static_cast<std::uint64_t>(RECORDS));
+}
+#endif
@@ -0,0 +1,67 @@
+#include "core/simulation/LevelSetup.hpp"
+#include "core/simulation/NetworkGenerator.hpp"
+#include "core/simulation/Simulation.hpp"
+#include "core/utils/LevelLoader.hpp"
+#include <gtest/gtest.h>
+#include <set>
+#include <sstream>
+
+namespace {
+
+NetworkGenParams smallParams(std::uint64_t seed) {
+    NetworkGenParams p;
+    p.seed = seed;
+    p.stations = 300;
+    p.lines = 12;
+    p.minLineLength = 4;
+    p.maxLineLength = 20;
+    return p;
+}
+
+} // namespace
+
+TEST(NetworkGenerator, SameSeedSameNetwork) {
+    auto a = LevelLoader::toJson(NetworkGenerator::generate(smallParams(7)));
+    auto b = LevelLoader::toJson(NetworkGenerator::generate(smallParams(7)));
+    auto c = LevelLoader::toJson(NetworkGenerator::generate(smallParams(8)));
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+}
+
+TEST(NetworkGenerator, LinesAreSimpleAndBridgesCoverCrossings) {
+    LevelConfig cfg = NetworkGenerator::generate(smallParams(3));
+    ASSERT_EQ(cfg.initialStations.size(), 300u);
+    ASSERT_FALSE(cfg.initialLines.empty());
+    EXPECT_EQ(cfg.geography.size(), 2u);
+
+    for (const auto& line : cfg.initialLines) {
+        EXPECT_GE(line.stations.size(), 2u);
+        EXPECT_LE(line.stations.size(), 20u);
+        std::set<int> unique(line.stations.begin(), line.stations.end());
+        EXPECT_EQ(unique.size(), line.stations.size()) << "line " << line.id;
+    }
+
+    // Every edge gets built, including the river crossings.
+    Simulation sim(cfg.seed);
+    applyLevel(sim, cfg);
+    sim.step(std::chrono::milliseconds(1000));
+    auto snap = sim.snapshot();
+    ASSERT_EQ(snap.lines.size(), cfg.initialLines.size());
+    for (const auto& line : snap.lines) {
+        EXPECT_EQ(line.stationIds.size(), cfg.initialLines[line.id - 1].stations.size());
+    }
+    EXPECT_EQ(snap.trains.size(), cfg.initialLines.size() * 2);
+}
+
+TEST(NetworkGenerator, JsonRoundTripsThroughLevelLoader) {
+    LevelConfig cfg = NetworkGenerator::generate(smallParams(5));
+    nlohmann::json file;
+    file["levels"] = nlohmann::json::array({LevelLoader::toJson(cfg)});
+    std::istringstream in(file.dump());
+
+    LevelLoader loader(in);
+    ASSERT_EQ(loader.getAvailableLevels().size(), 1u);
+    LevelConfig loaded = loader.loadLevel(cfg.id);
+    EXPECT_EQ(LevelLoader::toJson(loaded), LevelLoader::toJson(cfg));
+    EXPECT_EQ(loaded.bridges, cfg.bridges);
+}
@@ -1,6 +1,7 @@
 #include "core/graph/Graph.hpp"
 #include "core/graph/Passenger.hpp"
 #include "core/graph/StationType.hpp"
+#include "core/graph/passenger_pool.hpp"
 #include "core/graph/passenger_state_machine.hpp"
 #include <gtest/gtest.h>
 
@@ -17,7 +18,7 @@ TEST(PassengerAging, WaitingPassengersAgeEachTick) {
 
     const auto& waiting = g.getStation(A)->waitingPassengers;
     ASSERT_EQ(waiting.size(), 1);
-    EXPECT_EQ(waiting[0].age, 2);
+    EXPECT_EQ(g.passengers().age(waiting.front()), 2);
 }
 
 TEST(PassengerAging, OnboardPassengersDoNotAge) {
@@ -39,7 +40,40 @@ TEST(PassengerAging, OnboardPassengersDoNotAge) {
 
     const auto& t = g.getTrains()[0];
     ASSERT_EQ(t.onboard.size(), 1);
-    EXPECT_EQ(t.onboard[0].age, 1); // 1 Alighting tick
+    EXPECT_EQ(g.passengers().age(t.onboard.front()), 1); // 1 Alighting tick
+}
+
+TEST(PassengerAging, AgeFreezesOnTrainAndResumesAfterTransfer) {
+    PassengerPool pool;
+    PassengerHandle p = pool.create(1, 1, StationType::SQUARE);
+    pool.advanceAgingClock();
+    pool.advanceAgingClock();
+    EXPECT_EQ(pool.age(p), 2);
+
+    PassengerFSM::waitingToOnTrain(pool, p, 1);
+    pool.advanceAgingClock();
+    pool.advanceAgingClock();
+    EXPECT_EQ(pool.age(p), 2);
+
+    PassengerFSM::onTrainToTransferring(pool, p, 2);
+    pool.advanceAgingClock();
+    EXPECT_EQ(pool.age(p), 3);
+    EXPECT_EQ(pool.waitingSince(p), pool.agingClock() - 3);
+}
+
+TEST(PassengerAging, WaitTimesListEveryWaitingPassenger) {
+    Graph g;
+    auto A = g.addStation(StationType::CIRCLE);
+    auto B = g.addStation(StationType::SQUARE);
+
+    g.spawnPassengerAt(A, StationType::SQUARE);
+    g.tick();
+    g.spawnPassengerAt(B, StationType::CIRCLE);
+    g.tick();
+
+    std::vector<std::uint32_t> waits;
+    g.collectWaitTimes(waits);
+    EXPECT_EQ(waits, (std::vector<std::uint32_t>{2, 1}));
 }
 
 TEST(BoardingPolicy, FIFOPreservesArrivalOrder) {
@@ -62,7 +96,7 @@ TEST(BoardingPolicy, FIFOPreservesArrivalOrder) {
 
     const auto& onboard = g.getTrains()[0].onboard;
     ASSERT_EQ(onboard.size(), 1);
-    EXPECT_GT(onboard[0].age, 0);
+    EXPECT_GT(g.passengers().age(onboard.front()), 0);
 }
 
 TEST(BoardingPolicy, ShortestRemainingHopWins) {
@@ -93,7 +127,40 @@ TEST(BoardingPolicy, ShortestRemainingHopWins) {
 
     const auto& onboard = g.getTrains()[0].onboard;
     ASSERT_EQ(onboard.size(), 1);
-    EXPECT_EQ(onboard[0].destination, StationType::SQUARE);
+    EXPECT_EQ(g.passengers().destination(onboard.front()), StationType::SQUARE);
+}
+
+namespace {
+struct LongestTripFirst {
+    static std::uint32_t key(const BoardingContext& ctx, PassengerHandle p) {
+        return UINT32_MAX - ctx.hopsTo(ctx.passengers.destination(p));
+    }
+};
+} // namespace
+
+TEST(BoardingPolicy, CustomRulePlugsIntoBoarding) {
+    Graph g;
+    g.setBoardingRule<LongestTripFirst>();
+
+    auto A = g.addStation(StationType::CIRCLE);
+    auto B = g.addStation(StationType::SQUARE);
+    auto C = g.addStation(StationType::TRIANGLE);
+
+    auto line = g.addLine();
+    g.addStationToLine(line, A);
+    g.addStationToLine(line, B);
+    g.addStationToLine(line, C);
+    g.addTrain(line, 1);
+
+    g.spawnPassengerAt(A, StationType::SQUARE);   // 1 hop
+    g.spawnPassengerAt(A, StationType::TRIANGLE); // 2 hops
+
+    g.tick(); // A Alighting
+    g.tick(); // A Boarding
+
+    const auto& onboard = g.getTrains()[0].onboard;
+    ASSERT_EQ(onboard.size(), 1);
+    EXPECT_EQ(g.passengers().destination(onboard.front()), StationType::TRIANGLE);
 }
 
 TEST(Fairness, AgingEventuallyOverridesDistance) {
@@ -123,7 +190,7 @@ TEST(Fairness, AgingEventuallyOverridesDistance) {
 
     const auto& onboard = g.getTrains()[0].onboard;
     ASSERT_EQ(onboard.size(), 1);
-    EXPECT_EQ(onboard[0].destination, StationType::TRIANGLE);
+    EXPECT_EQ(g.passengers().destination(onboard.front()), StationType::TRIANGLE);
 }
 
 TEST(Invariant, PassengerOwnershipIsExclusive) {
@@ -220,8 +287,9 @@ TEST(Week7Determinism, PolicyAndAgingDeterministic) {
 }
 
 TEST(PassengerFSM, IllegalTransitionFails) {
-    Passenger p = {1, StationType::CIRCLE, StationType::SQUARE, PassengerState::WAITING};
-    p.state = PassengerState::COMPLETED;
+    PassengerPool pool;
+    PassengerHandle p = pool.create(1, 1, StationType::SQUARE);
+    pool.state(p) = PassengerState::COMPLETED;
 
-    EXPECT_THROW(PassengerFSM::waitingToOnTrain(p, 1), std::logic_error);
+    EXPECT_THROW(PassengerFSM::waitingToOnTrain(pool, p, 1), std::logic_error);
 }
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include "core/graph/Graph.hpp"
+#include <algorithm>
+#include <random>
+#include <stdexcept>
 
 TEST(PassengerPressure, PassengersAccumulateIfNoTrain) {
     Graph g;
@@ -75,3 +78,112 @@ TEST(PassengerPressure, FailureIsPermanent) {
     EXPECT_TRUE(g.isFailed());
 }
 
+
+TEST(PassengerPool, ReleasedHandlesAreReused) {
+    PassengerPool pool;
+    PassengerHandle a = pool.create(1, 1, StationType::SQUARE);
+    PassengerHandle b = pool.create(2, 1, StationType::TRIANGLE);
+    pool.route(a) = {1, 2};
+
+    pool.release(a);
+    EXPECT_FALSE(pool.alive(a));
+    EXPECT_THROW(pool.release(a), std::logic_error);
+
+    PassengerHandle c = pool.create(3, 2, StationType::CIRCLE);
+    EXPECT_EQ(c, a);
+    EXPECT_EQ(pool.size(), 2u);
+    EXPECT_EQ(pool.id(c), 3u);
+    EXPECT_EQ(pool.origin(c), 2u);
+    EXPECT_EQ(pool.state(c), PassengerState::WAITING);
+    EXPECT_EQ(pool.station(c), std::optional<StationId>(2));
+    EXPECT_TRUE(pool.route(c).empty());
+    EXPECT_EQ(pool.id(b), 2u);
+}
+
+TEST(PassengerPool, QueueUnlinkKeepsArrivalOrder) {
+    PassengerPool pool;
+    PassengerQueue q;
+    std::vector<PassengerHandle> hs;
+    for (PassengerId id = 1; id <= 4; ++id) {
+        hs.push_back(pool.create(id, 1, StationType::SQUARE));
+        pool.pushBack(q, hs.back());
+    }
+
+    pool.unlink(q, hs[1]);
+    pool.unlink(q, hs[3]);
+    pool.pushBack(q, hs[1]);
+
+    std::vector<PassengerHandle> order(pool.members(q).begin(), pool.members(q).end());
+    EXPECT_EQ(order, (std::vector<PassengerHandle>{hs[0], hs[2], hs[1]}));
+    EXPECT_EQ(q.size(), 3u);
+
+    pool.unlink(q, hs[0]);
+    pool.unlink(q, hs[2]);
+    pool.unlink(q, hs[1]);
+    EXPECT_TRUE(q.empty());
+    EXPECT_EQ(q.front(), NO_PASSENGER);
+}
+
+TEST(HopBucket, LowestKeyBoardsFirstAndTiesKeepArrivalOrder) {
+    PassengerPool pool;
+    HopBucket bucket(2);
+    std::vector<PassengerHandle> hs;
+    for (std::uint32_t key : {5u, 3u, 5u, 7u, 3u}) {
+        hs.push_back(pool.create(static_cast<PassengerId>(hs.size() + 1), 1, StationType::SQUARE));
+        bucket.push(pool, hs.back(), key);
+    }
+
+    std::vector<PassengerHandle> order;
+    bucket.forEach(pool, [&](PassengerHandle h) { order.push_back(h); });
+    EXPECT_EQ(order, (std::vector<PassengerHandle>{hs[1], hs[4], hs[0], hs[2], hs[3]}));
+
+    EXPECT_EQ(bucket.popFront(pool), hs[1]);
+    EXPECT_EQ(bucket.popFront(pool), hs[4]);
+    EXPECT_EQ(bucket.front(), hs[0]);
+    EXPECT_EQ(bucket.size(), 3u);
+}
+
+TEST(HopBucket, KeepsKeyOrderAcrossPopsAndOutOfOrderPushes) {
+    PassengerPool pool;
+    HopBucket bucket(2);
+    std::mt19937 rng(7);
+    std::vector<std::pair<std::uint32_t, PassengerHandle>> expected; // (key, handle), stable
+    auto push = [&](std::uint32_t key) {
+        PassengerHandle h =
+            pool.create(static_cast<PassengerId>(expected.size() + 1), 1, StationType::SQUARE);
+        bucket.push(pool, h, key);
+        auto at = std::upper_bound(expected.begin(), expected.end(), key,
+                                   [](std::uint32_t k, const auto& e) { return k < e.first; });
+        expected.insert(at, {key, h});
+    };
+
+    // Re-keying files passengers in arbitrary key order.
+    for (int i = 0; i < 200; ++i) {
+        push(rng() % 60);
+    }
+    // Boarding drains the front levels while new arrivals land anywhere, including below the
+    // current front.
+    for (int round = 0; round < 150; ++round) {
+        ASSERT_EQ(bucket.front(), expected.front().second);
+        ASSERT_EQ(bucket.popFront(pool), expected.front().second);
+        expected.erase(expected.begin());
+        if (round % 3 == 0) {
+            push(rng() % 60);
+        }
+    }
+    std::vector<PassengerHandle> order;
+    bucket.forEach(pool, [&](PassengerHandle h) { order.push_back(h); });
+    std::vector<PassengerHandle> want;
+    for (const auto& e : expected) {
+        want.push_back(e.second);
+    }
+    EXPECT_EQ(order, want);
+    EXPECT_EQ(bucket.size(), expected.size());
+
+    while (!bucket.empty()) {
+        ASSERT_EQ(bucket.popFront(pool), expected.front().second);
+        expected.erase(expected.begin());
+    }
+    EXPECT_EQ(bucket.front(), NO_PASSENGER);
+    EXPECT_THROW(bucket.popFront(pool), std::logic_error);
+}
@@ -0,0 +1,236 @@
+#include "core/graph/Graph.hpp"
+#include "core/simulation/LevelSetup.hpp"
+#include "core/simulation/NetworkGenerator.hpp"
+#include "core/simulation/RetainedSnapshot.hpp"
+#include "core/simulation/Simulation.hpp"
+#include <gtest/gtest.h>
+#include <set>
+#include <span>
+#include <sstream>
+#include <string>
+
+namespace {
+
+// Everything a SimulationSnapshot holds, spelled out so two can be compared as strings.
+std::string describe(const SimulationSnapshot& s) {
+    std::ostringstream os;
+    auto passengers = [&](std::span<const PassengerView> views) {
+        for (const auto& p : views) {
+            os << " p" << p.id << ":" << p.origin << ":" << static_cast<int>(p.destination) << ":"
+               << static_cast<int>(p.state) << ":" << p.stationId.value_or(0) << ":"
+               << p.trainId.value_or(0) << ":" << p.age;
+        }
+        os << "\n";
+    };
+    auto path = [&](const Polyline& poly) {
+        os << " " << poly.totalLength << ":" << poly.bridge << ":" << poly.bridgeIndices.size();
+        for (const auto& pt : poly.points) {
+            os << ":" << pt.x << "," << pt.y;
+        }
+    };
+
+    os << "tick " << s.tick << " score " << s.score << "\n";
+    for (const auto& st : s.stations) {
+        os << "station " << st.id << " " << static_cast<int>(st.type) << " " << st.waiting;
+        passengers(s.passengersOf(st.passengers));
+    }
+    for (const auto& t : s.trains) {
+        os << "train " << t.id << " " << t.lineId << " " << t.stationId << " " << t.nextStationId
+           << " " << t.forward << " " << t.capacity << " " << t.onboard << " "
+           << static_cast<int>(t.state) << " " << t.progress;
+        passengers(s.passengersOf(t.passengers));
+    }
+    os << "passengers";
+    passengers(s.passengers);
+    for (const auto& line : s.lines) {
+        os << "line " << line.id;
+        for (auto id : line.stationIds) {
+            os << " " << id;
+        }
+        os << "\n";
+    }
+    for (const auto& [id, pos] : s.stationPositions) {
+        os << "at " << id << " " << pos.first << "," << pos.second << "\n";
+    }
+    for (const auto& [id, paths] : s.linePaths) {
+        os << "line path " << id;
+        for (const auto& poly : paths) {
+            path(poly);
+        }
+        os << "\n";
+    }
+    for (const auto& [key, poly] : s.edgePaths) {
+        os << "edge " << key.first << "-" << key.second;
+        path(poly);
+        os << "\n";
+    }
+    for (const auto& [id, pos] : s.trainPositions) {
+        os << "train at " << id << " " << pos.first << "," << pos.second << "\n";
+    }
+    return os.str();
+}
+
+} // namespace
+
+TEST(RetainedSnapshot, MatchesFullSnapshotAfterEveryUpdate) {
+    NetworkGenParams params;
+    params.seed = 21;
+    params.stations = 80;
+    params.lines = 6;
+    params.maxLineLength = 10;
+    LevelConfig cfg = NetworkGenerator::generate(params);
+    Simulation sim(cfg.seed);
+    applyLevel(sim, cfg);
+
+    RetainedSnapshot retained;
+    std::uint32_t nextStation = static_cast<std::uint32_t>(cfg.initialStations.size()) + 1;
+    for (int tick = 0; tick < 300; ++tick) {
+        if (tick % 50 == 25) {
+            // Grows line 1 by a station next to its end, which adds an edge and a line path.
+            const LineView& line = retained.snapshot().lines.front();
+            auto [x, y] = retained.snapshot().stationPositions.at(line.stationIds.back());
+            sim.enqueueCommand(AddStationCmd{x + 20.0f, y + 20.0f, StationType::SQUARE});
+            sim.enqueueCommand(AddStationToLineCmd{line.id, nextStation,
+                                                   line.stationIds.back(), SIZE_MAX});
+            ++nextStation;
+        }
+        sim.step(std::chrono::milliseconds(1000));
+        if (tick % 4 == 3) {
+            continue; // let some changes pile up between updates
+        }
+        const SimulationSnapshot& view = retained.update(sim);
+        ASSERT_EQ(retained.version(), sim.changeVersion());
+        ASSERT_EQ(describe(view), describe(sim.snapshot())) << "tick " << tick;
+    }
+    EXPECT_EQ(retained.snapshot().lines.front().stationIds.size(),
+              cfg.initialLines.front().stations.size() + 6);
+    EXPECT_GT(retained.snapshot().score, 0u);
+}
+
+TEST(RetainedSnapshot, DeltaListsOnlyWhatChanged) {
+    Graph g;
+    auto a = g.addStation(StationType::CIRCLE);
+    auto b = g.addStation(StationType::SQUARE);
+    auto c = g.addStation(StationType::TRIANGLE);
+    auto line = g.addLine();
+    g.addStationToLine(line, a);
+    g.addStationToLine(line, b);
+    g.addTrain(line, 4, 0.25f);
+
+    GraphDelta delta;
+    g.changesSince(0, delta);
+    EXPECT_TRUE(delta.full);
+    EXPECT_EQ(delta.stations.size(), 3u);
+    EXPECT_EQ(delta.trains.size(), 1u);
+    const std::uint64_t start = delta.version;
+
+    // Nobody reads for a while: each member is still listed once.
+    for (int i = 0; i < 40; ++i) {
+        if (i % 4 == 0) {
+            g.spawnPassengerAt(a, StationType::SQUARE);
+        }
+        g.tick();
+    }
+    g.changesSince(start, delta);
+    EXPECT_FALSE(delta.full);
+    std::set<StationId> stations;
+    for (const auto& s : delta.stations) {
+        EXPECT_TRUE(stations.insert(s.id).second) << "station " << s.id << " listed twice";
+    }
+    EXPECT_EQ(stations, (std::set<StationId>{a, b}));
+    EXPECT_EQ(delta.trains.size(), 1u);
+    EXPECT_TRUE(delta.lines.empty());
+
+    // A removed station is listed as removed, not as changed.
+    const std::uint64_t current = delta.version;
+    g.removeStation(c);
+    g.changesSince(current, delta);
+    EXPECT_TRUE(delta.stations.empty());
+    EXPECT_EQ(delta.removedStations, std::vector<StationId>{c});
+
+    // A reader left behind by a newer read starts over.
+    g.changesSince(start, delta);
+    EXPECT_TRUE(delta.full);
+    EXPECT_EQ(delta.stations.size(), 2u);
+}
+
+TEST(RetainedSnapshot, RefilledSnapshotMatchesFreshOne) {
+    NetworkGenParams params;
+    params.seed = 5;
+    params.stations = 40;
+    params.lines = 4;
+    params.maxLineLength = 8;
+    LevelConfig cfg = NetworkGenerator::generate(params);
+    Simulation sim(cfg.seed);
+    applyLevel(sim, cfg);
+
+    SimulationSnapshot snap;
+    for (int tick = 0; tick < 120; ++tick) {
+        if (tick == 30) {
+            sim.enqueueCommand(AddLineCmd{}); // no path until it has two stations
+        }
+        if (tick % 40 == 35) {
+            const LineView& line = snap.lines.front();
+            auto [x, y] = snap.stationPositions.at(line.stationIds.back());
+            std::uint32_t station = static_cast<std::uint32_t>(snap.stations.size()) + 1;
+            sim.enqueueCommand(AddStationCmd{x + 20.0f, y + 20.0f, StationType::CIRCLE});
+            sim.enqueueCommand(AddStationToLineCmd{line.id, station, line.stationIds.back(),
+                                                   SIZE_MAX});
+        }
+        sim.step(std::chrono::milliseconds(1000));
+        sim.snapshot(snap);
+        ASSERT_EQ(describe(snap), describe(sim.snapshot())) << "tick " << tick;
+    }
+    EXPECT_EQ(snap.lines.size(), cfg.initialLines.size() + 1);
+    EXPECT_EQ(snap.linePaths.size(), cfg.initialLines.size());
+    EXPECT_EQ(snap.lines.front().stationIds.size(), cfg.initialLines.front().stations.size() + 3);
+}
+
+TEST(RetainedSnapshot, RefilledGraphSnapshotDropsRemovedMembers) {
+    Graph g;
+    auto a = g.addStation(StationType::CIRCLE);
+    auto b = g.addStation(StationType::SQUARE);
+    auto c = g.addStation(StationType::TRIANGLE);
+    auto first = g.addLine();
+    g.addStationToLine(first, a);
+    g.addStationToLine(first, b);
+    auto second = g.addLine();
+    g.addStationToLine(second, b);
+    g.addStationToLine(second, c);
+    g.spawnPassengerAt(a, StationType::TRIANGLE);
+
+    GraphSnapshot snap;
+    g.snapshot(snap);
+    EXPECT_EQ(snap.lines.size(), 2u);
+    EXPECT_EQ(snap.passengers.size(), 1u);
+
+    g.removeLine(first);
+    g.removeStation(c);
+    g.snapshot(snap);
+    ASSERT_EQ(snap.lines.size(), 1u);
+    EXPECT_EQ(snap.lines[0].id, second);
+    EXPECT_EQ(snap.lines[0].stationIds, std::vector<StationId>{b});
+    EXPECT_EQ(snap.stations.size(), 2u);
+    EXPECT_EQ(snap.passengersOf(snap.stations[0].passengers).size(), 1u);
+}
+
+TEST(RetainedSnapshot, RemovedStationLosesItsPosition) {
+    Graph g;
+    auto a = g.addStation(StationType::CIRCLE);
+    auto b = g.addStation(StationType::SQUARE);
+
+    RetainedSnapshot retained;
+    SimulationDelta delta{};
+    g.changesSince(0, delta.graph);
+    delta.stationPositions = {{a, {10.0f, 10.0f}}, {b, {50.0f, 10.0f}}};
+    retained.apply(delta);
+    ASSERT_EQ(retained.snapshot().stationPositions.size(), 2u);
+
+    g.removeStation(b);
+    g.changesSince(retained.version(), delta.graph);
+    delta.stationPositions.clear();
+    retained.apply(delta);
+    EXPECT_EQ(retained.snapshot().stations.size(), 1u);
+    EXPECT_EQ(retained.snapshot().stationPositions.size(), 1u);
+    EXPECT_FALSE(retained.snapshot().stationPositions.contains(b));
+}
@@ -105,3 +105,132 @@ TEST(Monotonicity, PassengerNeverRevisitsStation) {
 
     EXPECT_EQ(g.completedPassengers(), 1);
 }
+
+TEST(RoutingTable, NextHopLeadsToNearestStationOfType) {
+    Graph g;
+
+    auto A = g.addStation(StationType::CIRCLE);
+    auto B = g.addStation(StationType::SQUARE);
+    auto C = g.addStation(StationType::CIRCLE);
+    auto D = g.addStation(StationType::TRIANGLE);
+    auto E = g.addStation(StationType::TRIANGLE);
+
+    auto l1 = g.addLine();
+    g.addStationToLine(l1, D);
+    g.addStationToLine(l1, A);
+    g.addStationToLine(l1, B);
+    g.addStationToLine(l1, C);
+    g.addStationToLine(l1, E);
+
+    EXPECT_EQ(g.nextHop(A, StationType::TRIANGLE), D);
+    EXPECT_EQ(g.nextHop(C, StationType::TRIANGLE), E);
+    EXPECT_EQ(g.nextHop(B, StationType::CIRCLE).has_value(), true);
+    EXPECT_FALSE(g.nextHop(D, StationType::TRIANGLE).has_value());
+    EXPECT_FALSE(g.canRoute(D, StationType::TRIANGLE));
+    EXPECT_FALSE(g.canRoute(A, StationType::STAR));
+}
+
+TEST(RoutingTable, InvalidStationThrows) {
+    Graph g;
+    g.addStation(StationType::CIRCLE);
+
+    EXPECT_THROW(g.canRoute(42, StationType::SQUARE), std::logic_error);
+}
+
+TEST(RoutingInvalidation, IsolatedStationInvalidatesNothing) {
+    Graph g;
+
+    auto A = g.addStation(StationType::CIRCLE);
+    auto B = g.addStation(StationType::SQUARE);
+    auto line = g.addLine();
+    g.addStationToLine(line, A);
+    g.addStationToLine(line, B);
+
+    ASSERT_TRUE(g.canRoute(A, StationType::SQUARE));
+    auto before = g.routingStats();
+
+    auto C = g.addStation(StationType::TRIANGLE);
+    EXPECT_FALSE(g.canRoute(A, StationType::TRIANGLE));
+    EXPECT_FALSE(g.canRoute(C, StationType::CIRCLE));
+
+    auto after = g.routingStats();
+    EXPECT_EQ(after.invalidatedEntries, before.invalidatedEntries);
+    EXPECT_EQ(after.misses, before.misses);
+    EXPECT_EQ(after.hits, before.hits + 2);
+}
+
+TEST(RoutingInvalidation, LineEditOnlyTouchesItsComponent) {
+    Graph g;
+
+    auto A = g.addStation(StationType::CIRCLE);
+    auto B = g.addStation(StationType::SQUARE);
+    auto C = g.addStation(StationType::CIRCLE);
+    auto D = g.addStation(StationType::SQUARE);
+    auto E = g.addStation(StationType::TRIANGLE);
+
+    auto l1 = g.addLine();
+    auto l2 = g.addLine();
+    g.addStationToLine(l1, A);
+    g.addStationToLine(l1, B);
+    g.addStationToLine(l2, C);
+    g.addStationToLine(l2, D);
+
+    ASSERT_TRUE(g.canRoute(A, StationType::SQUARE));
+    auto before = g.routingStats();
+
+    g.addStationToLine(l1, E); // component {A, B, E}; {C, D} untouched
+    EXPECT_TRUE(g.canRoute(A, StationType::TRIANGLE));
+    EXPECT_TRUE(g.canRoute(C, StationType::SQUARE));
+
+    auto after = g.routingStats();
+    // CIRCLE, SQUARE and TRIANGLE are present in the component, STAR is skipped.
+    EXPECT_EQ(after.typeRebuilds - before.typeRebuilds, 3u);
+    EXPECT_EQ(after.invalidatedEntries - before.invalidatedEntries, 3u * 3u);
+    EXPECT_EQ(after.misses - before.misses, 1u);
+}
+
+TEST(RoutingInvalidation, IncrementalMatchesFullSearch) {
+    Graph g;
+    std::vector<std::uint32_t> stations;
+    for (int i = 0; i < 12; ++i) {
+        stations.push_back(g.addStation(static_cast<StationType>(i % StationType::COUNT)));
+    }
+    auto l1 = g.addLine();
+    auto l2 = g.addLine();
+    auto l3 = g.addLine();
+
+    auto check = [&]() {
+        for (auto s : stations) {
+            if (!g.stationExists(s))
+                continue;
+            for (int t = 0; t < StationType::COUNT; ++t) {
+                auto type = static_cast<StationType>(t);
+                std::size_t hops = g.estimateRemainingHops(s, type);
+                bool routable = hops != SIZE_MAX && hops > 0;
+                ASSERT_EQ(g.canRoute(s, type), routable);
+                if (routable) {
+                    auto hop = g.nextHop(s, type);
+                    ASSERT_TRUE(hop.has_value());
+                    EXPECT_EQ(g.estimateRemainingHops(*hop, type), hops - 1);
+                }
+            }
+        }
+    };
+
+    for (int i = 0; i < 5; ++i)
+        g.addStationToLine(l1, stations[i]);
+    check();
+    for (int i = 4; i < 9; ++i)
+        g.addStationToLine(l2, stations[i]);
+    check();
+    g.addStationToLineAtIndex(l3, stations[9], 0);
+    g.addStationToLineAtIndex(l3, stations[10], 0);
+    g.addStationToLineAtIndex(l3, stations[2], 1);
+    check();
+    g.removeStation(stations[4]);
+    check();
+    g.removeLine(l3);
+    check();
+    g.addStationToLineAtIndex(l1, stations[11], 2);
+    check();
+}
@@ -0,0 +1,154 @@
+#include "core/simulation/LevelSetup.hpp"
+#include "core/simulation/NetworkGenerator.hpp"
+#include "core/simulation/Simulation.hpp"
+#include "core/simulation/SimulationThread.hpp"
+#include "core/utils/MpscQueue.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+LevelConfig threadLevel() {
+    NetworkGenParams params;
+    params.seed = 5;
+    params.stations = 60;
+    params.lines = 5;
+    params.maxLineLength = 10;
+    return NetworkGenerator::generate(params);
+}
+
+// Reads snapshots until `count` have been published, checking that they only move forward.
+void readUntil(SimulationThread& runner, std::uint64_t count) {
+    std::uint64_t lastTick = 0;
+    while (runner.published() < count && runner.running()) {
+        const SimulationSnapshot& snap = runner.latest();
+        ASSERT_GE(snap.tick, lastTick);
+        lastTick = snap.tick;
+        std::this_thread::yield();
+    }
+}
+
+} // namespace
+
+TEST(MpscQueue, KeepsEachProducersOrder) {
+    constexpr int PRODUCERS = 4;
+    constexpr int PER_PRODUCER = 20000;
+    MpscQueue<std::pair<int, int>> queue;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&queue, p] {
+            for (int i = 0; i < PER_PRODUCER; ++i) {
+                queue.push({p, i});
+            }
+        });
+    }
+
+    std::vector<int> next(PRODUCERS, 0);
+    int popped = 0;
+    std::pair<int, int> value;
+    while (popped < PRODUCERS * PER_PRODUCER) {
+        if (!queue.tryPop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(value.second, next[value.first]++) << "producer " << value.first;
+        ++popped;
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    EXPECT_FALSE(queue.tryPop(value));
+}
+
+TEST(SimulationThread, MatchesSteppingOnTheCallerThread) {
+    LevelConfig cfg = threadLevel();
+    Simulation threaded(cfg.seed);
+    Simulation serial(cfg.seed);
+    applyLevel(threaded, cfg);
+    applyLevel(serial, cfg);
+
+    // One tick per step and no sleeping, so the run is as fast as the simulation.
+    SimulationThread runner(threaded, std::chrono::milliseconds(0),
+                            std::chrono::milliseconds(1000));
+    runner.start();
+    readUntil(runner, 120);
+    runner.stop();
+
+    ASSERT_GE(threaded.tickCount(), 119u);
+    for (std::uint64_t i = 0; i < threaded.tickCount(); ++i) {
+        serial.step(std::chrono::milliseconds(1000));
+    }
+    EXPECT_EQ(threaded.stateHash(), serial.stateHash());
+
+    // Every tick was published, so the latest snapshot is the final state.
+    const SimulationSnapshot& last = runner.latest();
+    SimulationSnapshot expected = serial.snapshot();
+    EXPECT_EQ(last.tick, expected.tick);
+    EXPECT_EQ(last.score, expected.score);
+    ASSERT_EQ(last.stations.size(), expected.stations.size());
+    for (std::size_t i = 0; i < last.stations.size(); ++i) {
+        EXPECT_EQ(last.stations[i].waiting, expected.stations[i].waiting);
+    }
+    ASSERT_EQ(last.trains.size(), expected.trains.size());
+    for (std::size_t i = 0; i < last.trains.size(); ++i) {
+        EXPECT_EQ(last.trains[i].state, expected.trains[i].state);
+        EXPECT_EQ(last.trains[i].progress, expected.trains[i].progress);
+        EXPECT_EQ(last.trainPositions.at(last.trains[i].id),
+                  expected.trainPositions.at(expected.trains[i].id));
+    }
+    EXPECT_EQ(last.passengers.size(), expected.passengers.size());
+}
+
+TEST(SimulationThread, TakesCommandsFromSeveralThreads) {
+    LevelConfig cfg = threadLevel();
+    Simulation sim(cfg.seed);
+    applyLevel(sim, cfg);
+    SimulationThread runner(sim, std::chrono::milliseconds(1), std::chrono::milliseconds(250));
+    runner.start();
+
+    std::vector<std::thread> senders;
+    for (int s = 0; s < 3; ++s) {
+        senders.emplace_back([&sim] {
+            for (int i = 0; i < 20; ++i) {
+                sim.enqueueCommand(AddLineCmd{});
+                std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& t : senders) {
+        t.join();
+    }
+    // Commands sent before a tick are in the snapshot published after it.
+    const std::uint64_t sent = runner.published();
+    readUntil(runner, sent + 2);
+    runner.stop();
+    EXPECT_EQ(runner.latest().lines.size(), cfg.initialLines.size() + 60);
+}
+
+TEST(SimulationThread, LogStaysBoundedWithoutAReader) {
+    LevelConfig cfg = threadLevel();
+    Simulation sim(cfg.seed);
+    applyLevel(sim, cfg);
+    SimulationThread runner(sim, std::chrono::milliseconds(0), std::chrono::milliseconds(1000));
+
+    // Nobody calls latest(), so the reader's buffer never catches up.
+    runner.start();
+    while (runner.published() < 4 * SimulationThread::MAX_LOG_DELTAS && runner.running()) {
+        std::this_thread::yield();
+    }
+    runner.stop();
+    EXPECT_LE(runner.loggedDeltas(), SimulationThread::MAX_LOG_DELTAS);
+
+    // The buffer left behind is rebuilt from a full delta once the reader lets go of it.
+    runner.latest();
+    runner.start();
+    readUntil(runner, runner.published() + 4);
+    runner.stop();
+    const SimulationSnapshot& last = runner.latest();
+    SimulationSnapshot expected = sim.snapshot();
+    EXPECT_EQ(last.tick, expected.tick);
+    EXPECT_EQ(last.passengers.size(), expected.passengers.size());
+    EXPECT_EQ(last.stationPositions, expected.stationPositions);
+    EXPECT_LE(runner.loggedDeltas(), SimulationThread::MAX_LOG_DELTAS);
+}
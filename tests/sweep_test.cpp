@@ -0,0 +1,79 @@
+#include "core/simulation/CommandScript.hpp"
+#include "core/simulation/MonteCarloSweep.hpp"
+#include "core/utils/ThreadPool.hpp"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+SweepConfig smallSweep(std::size_t threads) {
+    SweepConfig cfg;
+    cfg.level.initialStations = {
+        {100, 100, "CIRCLE", 0}, {300, 100, "SQUARE", 0}, {200, 300, "TRIANGLE", 0}};
+    cfg.level.initialLines = {{1, "#ff0000"}};
+    std::istringstream script("connect 1 1 0\n"
+                              "connect 1 2 1\n"
+                              "connect 1 3 2\n"
+                              "@1 train 1\n");
+    cfg.script = CommandScript::parse(script);
+    cfg.seeds = {1, 2, 3, 4, 5};
+    cfg.policies = {FIFO, SHORTEST_REMAINING_HOPS, AGING_PRIORITY};
+    cfg.limits = {.ticks = 300, .frame = std::chrono::milliseconds(1000)};
+    cfg.threads = threads;
+    return cfg;
+}
+
+} // namespace
+
+TEST(ThreadPool, RunsEveryTaskAndRethrows) {
+    ThreadPool pool(4);
+    std::atomic<int> sum{0};
+    for (int i = 1; i <= 100; ++i) {
+        pool.submit([&sum, i] { sum += i; });
+    }
+    pool.wait();
+    EXPECT_EQ(sum.load(), 5050);
+
+    std::vector<int> squares(50, 0);
+    pool.parallelFor(squares.size(), [&](std::size_t i) { squares[i] = int(i * i); });
+    for (std::size_t i = 0; i < squares.size(); ++i) {
+        EXPECT_EQ(squares[i], int(i * i));
+    }
+
+    pool.submit([] { throw std::runtime_error("boom"); });
+    EXPECT_THROW(pool.wait(), std::runtime_error);
+    pool.wait(); // the error is reported once
+}
+
+TEST(MonteCarloSweep, ResultsDoNotDependOnThreadCount) {
+    SweepResult serial = MonteCarloSweep::run(smallSweep(1));
+    SweepResult parallel = MonteCarloSweep::run(smallSweep(4));
+
+    ASSERT_EQ(serial.runs.size(), 15u);
+    ASSERT_EQ(parallel.runs.size(), serial.runs.size());
+    for (std::size_t i = 0; i < serial.runs.size(); ++i) {
+        EXPECT_TRUE(serial.runs[i].error.empty()) << serial.runs[i].error;
+        EXPECT_EQ(parallel.runs[i].seed, serial.runs[i].seed);
+        EXPECT_EQ(parallel.runs[i].policy, serial.runs[i].policy);
+        EXPECT_EQ(parallel.runs[i].outcome.ticks, serial.runs[i].outcome.ticks);
+        EXPECT_EQ(parallel.runs[i].outcome.completedPassengers,
+                  serial.runs[i].outcome.completedPassengers);
+        EXPECT_EQ(parallel.runs[i].outcome.failureTick, serial.runs[i].outcome.failureTick);
+        EXPECT_EQ(parallel.runs[i].queueHistogram, serial.runs[i].queueHistogram);
+    }
+
+    std::ostringstream a, b;
+    MonteCarloSweep::writeSummaryCsv(a, serial);
+    MonteCarloSweep::writeSummaryCsv(b, parallel);
+    EXPECT_EQ(a.str(), b.str());
+
+    ASSERT_EQ(serial.summaries.size(), 3u);
+    for (const auto& s : serial.summaries) {
+        EXPECT_EQ(s.runs, 5u);
+        EXPECT_LE(s.queueP50, s.queueP90);
+        EXPECT_LE(s.queueP90, s.queueP99);
+        EXPECT_LE(s.queueP99, s.queueMax);
+    }
+}
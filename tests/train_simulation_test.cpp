@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include "core/graph/Graph.hpp"
 #include "core/graph/StationType.hpp"
+#include "core/utils/ThreadPool.hpp"
 
 TEST(TrainMovement, MovesForwardOneStation) {
     Graph g;
@@ -134,3 +135,214 @@ TEST(PassengerDropoff, DoesNotDropEarly) {
     EXPECT_EQ(g.getTrains()[0].onboard.size(), 1);
 }
 
+
+TEST(TrainBoarding, TrainOnlyTakesPassengersHeadingItsWay) {
+    Graph g;
+
+    auto A = g.addStation(StationType::CIRCLE);
+    auto B = g.addStation(StationType::SQUARE);
+    auto C = g.addStation(StationType::TRIANGLE);
+
+    auto toB = g.addLine();
+    g.addStationToLine(toB, A);
+    g.addStationToLine(toB, B);
+    auto toC = g.addLine();
+    g.addStationToLine(toC, A);
+    g.addStationToLine(toC, C);
+
+    g.spawnPassengerAt(A, StationType::TRIANGLE);
+    g.spawnPassengerAt(A, StationType::SQUARE);
+    g.spawnPassengerAt(A, StationType::TRIANGLE);
+    g.addTrain(toB, 2);
+
+    g.tick(); // A Alighting, passengers are bucketed by next hop
+    const auto& buckets = g.getStation(A)->hopBuckets;
+    ASSERT_EQ(buckets.size(), 2u);
+    EXPECT_EQ(buckets[0].nextHop(), C);
+    EXPECT_EQ(buckets[0].size(), 2u);
+    EXPECT_EQ(buckets[1].nextHop(), B);
+    EXPECT_EQ(buckets[1].size(), 1u);
+
+    g.tick(); // A Boarding
+    EXPECT_EQ(g.getTrains()[0].onboard.size(), 1);
+    EXPECT_EQ(g.getStation(A)->waitingPassengers.size(), 2);
+    EXPECT_TRUE(buckets[1].empty());
+}
+
+TEST(TickScheduling, EventDrivenMatchesEveryTrain) {
+    auto build = [](Graph& g) {
+        std::vector<std::uint32_t> stations;
+        for (int i = 0; i < 12; ++i) {
+            stations.push_back(g.addStation(static_cast<StationType>(i % StationType::COUNT)));
+            g.getMutableStation(stations.back()).maxCapacity = 1000;
+        }
+        const float speeds[] = {0.1f, 0.3f, 1.0f, 0.07f};
+        for (int l = 0; l < 4; ++l) {
+            auto line = g.addLine();
+            for (int i = 0; i < 5; ++i) {
+                g.addStationToLine(line, stations[(l * 3 + i) % stations.size()]);
+            }
+            g.addTrain(line, 3, speeds[l]);
+            g.addTrain(line, 2, speeds[(l + 1) % 4]);
+        }
+        return stations;
+    };
+
+    Graph every;
+    Graph events;
+    auto stations = build(every);
+    build(events);
+    events.setTickScheduling(EVENT_DRIVEN);
+
+    for (int tick = 0; tick < 300; ++tick) {
+        if (tick % 3 == 0) {
+            auto at = stations[(tick * 7) % stations.size()];
+            int offset = 1 + (tick / 9) % (StationType::COUNT - 1);
+            auto type = static_cast<StationType>((every.getStation(at)->type + offset) %
+                                                 StationType::COUNT);
+            every.spawnPassengerAt(at, type);
+            events.spawnPassengerAt(at, type);
+        }
+        if (tick == 150) {
+            events.setTickScheduling(EVERY_TRAIN);
+            events.setTickScheduling(EVENT_DRIVEN);
+        }
+        every.tick();
+        events.tick();
+
+        auto a = every.snapshot();
+        auto b = events.snapshot();
+        ASSERT_EQ(a.trains.size(), b.trains.size());
+        for (std::size_t i = 0; i < a.trains.size(); ++i) {
+            EXPECT_EQ(a.trains[i].state, b.trains[i].state) << "tick " << tick << " train " << i;
+            EXPECT_EQ(a.trains[i].stationId, b.trains[i].stationId);
+            EXPECT_EQ(a.trains[i].onboard, b.trains[i].onboard);
+            EXPECT_NEAR(a.trains[i].progress, b.trains[i].progress, 1e-5f);
+        }
+        ASSERT_EQ(every.completedPassengers(), events.completedPassengers()) << "tick " << tick;
+        ASSERT_EQ(every.stateHash(), events.stateHash()) << "tick " << tick;
+    }
+    EXPECT_GT(every.completedPassengers(), 0u);
+}
+
+TEST(TickScheduling, ThreadPoolMatchesSerialTick) {
+    auto build = [](Graph& g) {
+        g.setRoutingPolicy(TRANSFER_AWARE);
+        std::vector<std::uint32_t> stations;
+        for (int i = 0; i < 40; ++i) {
+            stations.push_back(g.addStation(static_cast<StationType>(i % StationType::COUNT)));
+            g.getMutableStation(stations.back()).maxCapacity = 1000;
+        }
+        const float speeds[] = {0.1f, 0.3f, 1.0f, 0.07f};
+        for (int l = 0; l < 10; ++l) {
+            auto line = g.addLine();
+            for (int i = 0; i < 6; ++i) {
+                g.addStationToLine(line, stations[(l * 4 + i) % stations.size()]);
+            }
+            for (int t = 0; t < 5; ++t) {
+                g.addTrain(line, 2 + t % 3, speeds[(l + t) % 4]);
+            }
+        }
+        return stations;
+    };
+
+    auto ids = [](std::span<const PassengerView> views) {
+        std::vector<std::uint32_t> out;
+        for (const auto& v : views) {
+            out.push_back(v.id);
+        }
+        return out;
+    };
+
+    for (TickScheduling mode : {EVERY_TRAIN, EVENT_DRIVEN}) {
+        ThreadPool pool(4);
+        Graph serial;
+        Graph parallel;
+        auto stations = build(serial);
+        build(parallel);
+        serial.setTickScheduling(mode);
+        parallel.setTickScheduling(mode);
+        parallel.setTickPool(&pool);
+
+        for (int tick = 0; tick < 300; ++tick) {
+            for (int k = 0; k < 3; ++k) {
+                auto at = stations[(tick * 7 + k * 13) % stations.size()];
+                int offset = 1 + (tick / 9 + k) % (StationType::COUNT - 1);
+                auto type = static_cast<StationType>((serial.getStation(at)->type + offset) %
+                                                     StationType::COUNT);
+                serial.spawnPassengerAt(at, type);
+                parallel.spawnPassengerAt(at, type);
+            }
+            serial.tick();
+            parallel.tick();
+
+            auto a = serial.snapshot();
+            auto b = parallel.snapshot();
+            ASSERT_EQ(a.trains.size(), b.trains.size());
+            for (std::size_t i = 0; i < a.trains.size(); ++i) {
+                ASSERT_EQ(a.trains[i].state, b.trains[i].state)
+                    << "tick " << tick << " train " << i;
+                ASSERT_EQ(a.trains[i].stationId, b.trains[i].stationId);
+                ASSERT_EQ(a.trains[i].progress, b.trains[i].progress);
+                ASSERT_EQ(ids(a.passengersOf(a.trains[i].passengers)),
+                          ids(b.passengersOf(b.trains[i].passengers)));
+            }
+            ASSERT_EQ(a.stations.size(), b.stations.size());
+            for (std::size_t i = 0; i < a.stations.size(); ++i) {
+                ASSERT_EQ(ids(a.passengersOf(a.stations[i].passengers)),
+                          ids(b.passengersOf(b.stations[i].passengers)))
+                    << "tick " << tick << " station " << a.stations[i].id;
+            }
+            ASSERT_EQ(a.score, b.score) << "tick " << tick;
+            ASSERT_EQ(serial.stateHash(), parallel.stateHash()) << "tick " << tick;
+            ASSERT_EQ(parallel.stateHash(), parallel.computeStateHash()) << "tick " << tick;
+            ASSERT_EQ(serial.changeVersion(), parallel.changeVersion()) << "tick " << tick;
+        }
+        EXPECT_GT(serial.completedPassengers(), 0u);
+        // Lookups made by the tasks are all counted once their groups finish.
+        const RoutingCacheStats& s = serial.routingStats();
+        const RoutingCacheStats& p = parallel.routingStats();
+        EXPECT_EQ(s.hits + s.misses, p.hits + p.misses);
+    }
+}
+
+TEST(InvariantChecks, SampledModeChecksEveryNthTick) {
+    Graph g;
+    auto A = g.addStation(StationType::CIRCLE);
+    auto B = g.addStation(StationType::SQUARE);
+    auto line = g.addLine();
+    g.addStationToLine(line, A);
+    g.addStationToLine(line, B);
+    g.addTrain(line, 4);
+    g.addTrain(line, 4);
+
+    g.setInvariantChecks(InvariantChecks::OFF);
+    g.tick();
+    EXPECT_EQ(g.invariantChecksRun(), 0u);
+
+    g.setInvariantChecks(InvariantChecks::FULL);
+    g.tick();
+    EXPECT_EQ(g.invariantChecksRun(), 2u); // once per train
+
+    g.setInvariantChecks(InvariantChecks::SAMPLED, 5);
+    for (int i = 0; i < 20; ++i) {
+        g.tick();
+    }
+    EXPECT_EQ(g.invariantChecksRun(), 6u);
+    EXPECT_THROW(g.setInvariantChecks(InvariantChecks::SAMPLED, 0), std::logic_error);
+}
+
+TEST(InvariantChecks, SampledCheckReportsCorruptQueues) {
+    Graph g;
+    auto A = g.addStation(StationType::CIRCLE);
+    auto B = g.addStation(StationType::SQUARE);
+    auto line = g.addLine();
+    g.addStationToLine(line, A);
+    g.addStationToLine(line, B);
+    g.spawnPassengerAt(A, StationType::SQUARE);
+    g.setInvariantChecks(InvariantChecks::SAMPLED, 1);
+    g.tick();
+
+    g.getMutableStation(A).waitingPassengers.count = 7;
+    EXPECT_THROW(g.tick(), std::logic_error);
+}
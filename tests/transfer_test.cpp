@@ -47,3 +47,146 @@ TEST(Transfer, PassengerRejectsWrongLine) {
 
     EXPECT_EQ(g.getTrains()[0].onboard.size(), 0);
 }
+
+TEST(TransferAwareRouting, PrefersFewerTransfersOverFewerHops) {
+    Graph g;
+
+    auto A = g.addStation(StationType::CIRCLE);
+    auto X1 = g.addStation(StationType::SQUARE);
+    auto X2 = g.addStation(StationType::SQUARE);
+    auto X3 = g.addStation(StationType::SQUARE);
+    auto Y = g.addStation(StationType::SQUARE);
+    auto T = g.addStation(StationType::TRIANGLE);
+
+    auto l1 = g.addLine();
+    for (auto s : {A, X1, X2, X3, T})
+        g.addStationToLine(l1, s);
+    auto l2 = g.addLine();
+    g.addStationToLine(l2, A);
+    g.addStationToLine(l2, Y);
+    auto l3 = g.addLine();
+    g.addStationToLine(l3, Y);
+    g.addStationToLine(l3, T);
+
+    g.setRouteCosts({.hop = 1.0f, .transfer = 3.0f, .length = 0.0f});
+    auto route = g.planRoute(A, StationType::TRIANGLE);
+    ASSERT_TRUE(route.reachable);
+    EXPECT_EQ(route.stations, (std::vector<std::uint32_t>{A, X1, X2, X3, T}));
+    EXPECT_EQ(route.transfers, 0u);
+
+    g.setRouteCosts({.hop = 1.0f, .transfer = 1.0f, .length = 0.0f});
+    route = g.planRoute(A, StationType::TRIANGLE);
+    EXPECT_EQ(route.stations, (std::vector<std::uint32_t>{A, Y, T}));
+    EXPECT_EQ(route.lines, (std::vector<std::uint32_t>{l2, l3}));
+    EXPECT_EQ(route.transfers, 1u);
+}
+
+TEST(TransferAwareRouting, TrackLengthBreaksHopTies) {
+    Graph g;
+
+    auto A = g.addStation(StationType::CIRCLE);
+    auto B = g.addStation(StationType::SQUARE);
+    auto C = g.addStation(StationType::SQUARE);
+    auto T = g.addStation(StationType::TRIANGLE);
+
+    auto l1 = g.addLine();
+    for (auto s : {B, A, C, T})
+        g.addStationToLine(l1, s);
+    auto l2 = g.addLine();
+    g.addStationToLine(l2, B);
+    g.addStationToLine(l2, T);
+
+    g.setEdgeLength(A, B, 10.0f);
+    g.setEdgeLength(B, T, 10.0f);
+    g.setEdgeLength(A, C, 200.0f);
+    g.setEdgeLength(C, T, 200.0f);
+    g.setRouteCosts({.hop = 1.0f, .transfer = 0.0f, .length = 0.01f});
+
+    auto route = g.planRoute(A, StationType::TRIANGLE);
+    ASSERT_TRUE(route.reachable);
+    EXPECT_EQ(route.stations, (std::vector<std::uint32_t>{A, B, T}));
+}
+
+TEST(TransferAwareRouting, PassengerStoresAndFollowsCommittedRoute) {
+    Graph g;
+    g.setRoutingPolicy(RoutingPolicy::TRANSFER_AWARE);
+    g.setRouteCosts({.hop = 1.0f, .transfer = 3.0f, .length = 0.0f});
+
+    auto A = g.addStation(StationType::CIRCLE);
+    auto X1 = g.addStation(StationType::SQUARE);
+    auto X2 = g.addStation(StationType::SQUARE);
+    auto Y = g.addStation(StationType::SQUARE);
+    auto T = g.addStation(StationType::TRIANGLE);
+
+    auto l1 = g.addLine();
+    for (auto s : {A, X1, X2, T})
+        g.addStationToLine(l1, s);
+    auto l2 = g.addLine();
+    g.addStationToLine(l2, A);
+    g.addStationToLine(l2, Y);
+    auto l3 = g.addLine();
+    g.addStationToLine(l3, Y);
+    g.addStationToLine(l3, T);
+
+    g.addTrain(l1, 1);
+    g.addTrain(l2, 1);
+    g.addTrain(l3, 1);
+    g.spawnPassengerAt(A, StationType::TRIANGLE);
+
+    g.tick(); // A Alighting
+    g.tick(); // A Boarding
+
+    const auto& onboard = g.getTrains()[0].onboard;
+    ASSERT_EQ(onboard.size(), 1);
+    EXPECT_EQ(g.passengers().route(onboard.front()), (std::vector<std::uint32_t>{A, X1, X2, T}));
+    EXPECT_EQ(g.passengers().currentLine(onboard.front()), l1);
+    EXPECT_TRUE(g.getTrains()[1].onboard.empty());
+
+    for (int i = 0; i < 9; ++i)
+        g.tick();
+
+    EXPECT_EQ(g.completedPassengers(), 1);
+}
+
+TEST(TransferAwareRouting, PassengerBoardsOnlyItsPlannedLine) {
+    Graph g;
+    g.setRoutingPolicy(RoutingPolicy::TRANSFER_AWARE);
+
+    auto A = g.addStation(StationType::CIRCLE);
+    auto B = g.addStation(StationType::SQUARE);
+    auto C = g.addStation(StationType::SQUARE);
+    auto D = g.addStation(StationType::STAR);
+
+    auto l1 = g.addLine();
+    for (auto s : {A, B, C, D})
+        g.addStationToLine(l1, s);
+    auto l2 = g.addLine();
+    for (auto s : {A, B, C})
+        g.addStationToLine(l2, s);
+
+    auto route = g.planRoute(A, StationType::STAR);
+    ASSERT_TRUE(route.reachable);
+    EXPECT_EQ(route.lines, (std::vector<std::uint32_t>{l1, l1, l1}));
+    EXPECT_EQ(route.transfers, 0u);
+
+    // The line-2 train steps first and also heads for B, but it is not the planned line.
+    g.addTrain(l2, 1);
+    g.addTrain(l1, 1);
+    g.spawnPassengerAt(A, StationType::STAR);
+
+    g.tick(); // A Alighting
+    g.tick(); // A Boarding
+
+    const auto& onLine1 = g.getTrains()[1].onboard;
+    ASSERT_EQ(onLine1.size(), 1);
+    EXPECT_EQ(g.passengers().currentLine(onLine1.front()), l1);
+
+    for (int i = 0; i < 20 && g.completedPassengers() == 0; ++i) {
+        g.tick();
+        EXPECT_TRUE(g.getTrains()[0].onboard.empty());
+        for (auto s : {B, C})
+            EXPECT_EQ(g.getStation(s)->waitingPassengers.size(), 0);
+    }
+
+    EXPECT_EQ(g.completedPassengers(), 1);
+}